@@ -0,0 +1,147 @@
+// Description: Contour lines written by the dedicated thread using double buffering
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "AsyncContourLinesSink.h"
+
+
+AsyncContourLinesSink::AsyncContourLinesSink(const TVector <ContourLinesSink*>& sinks_, const int buffer_vertices_) : sinks(sinks_), buffer_vertices(buffer_vertices_),
+	filled(0), pending(false), finished(false)
+{
+	//Preallocate both buffers and start the writer thread
+	for (int i = 0; i < 2; i++)
+		buffers[i].reserve(buffer_vertices / 64, buffer_vertices);
+
+	writer = std::thread(&AsyncContourLinesSink::writeBuffers, this);
+}
+
+
+AsyncContourLinesSink::~AsyncContourLinesSink()
+{
+	//Stop the writer thread when the sink was not closed, e.g. after the exception
+	stop();
+}
+
+
+void AsyncContourLinesSink::addPolyline(const PolylineSpan& polyline, const int source_id)
+{
+	//Copy the contour line into the filled buffer, pass the full buffer to the writer thread
+	buffers[filled].addPolyline(polyline);
+	source_ids[filled].push_back(source_id);
+
+	if (buffers[filled].getVerticesCount() >= buffer_vertices)
+		submit();
+}
+
+
+void AsyncContourLinesSink::close()
+{
+	//Pass the rest of the contour lines, wait for the writer thread and close all sinks
+	if (buffers[filled].size() > 0)
+		submit();
+
+	stop();
+
+	//Throw exception of the writer thread
+	if (error)
+		std::rethrow_exception(error);
+
+	for (ContourLinesSink* sink : sinks)
+		sink->close();
+}
+
+
+void AsyncContourLinesSink::submit()
+{
+	//Swap buffers, wait until the writer thread finishes the previous buffer
+	{
+		std::unique_lock <std::mutex> lock(mutex);
+		condition.wait(lock, [this] { return !pending; });
+
+		//Throw exception of the writer thread
+		if (error)
+			std::rethrow_exception(error);
+
+		filled = 1 - filled;
+		pending = true;
+	}
+
+	condition.notify_all();
+
+	//Reuse the written buffer, its memory is kept
+	buffers[filled].clear();
+	source_ids[filled].clear();
+}
+
+
+void AsyncContourLinesSink::stop()
+{
+	//Let the writer thread finish the pending buffer and wait for it
+	if (!writer.joinable())
+		return;
+
+	{
+		std::lock_guard <std::mutex> lock(mutex);
+		finished = true;
+	}
+
+	condition.notify_all();
+	writer.join();
+}
+
+
+void AsyncContourLinesSink::writeBuffers()
+{
+	//Writer thread: send contour lines of the passed buffers to all sinks
+	for (;;)
+	{
+		std::unique_lock <std::mutex> lock(mutex);
+		condition.wait(lock, [this] { return pending || finished; });
+
+		//No more buffers
+		if (!pending)
+			return;
+
+		const int written = 1 - filled;
+		lock.unlock();
+
+		//Write buffer, the first exception stops the writing
+		if (!error)
+		{
+			try
+			{
+				for (int i = 0; i < buffers[written].size(); i++)
+					for (ContourLinesSink* sink : sinks)
+						sink->addPolyline(buffers[written][i], source_ids[written][i]);
+			}
+
+			catch (...)
+			{
+				error = std::current_exception();
+			}
+		}
+
+		lock.lock();
+		pending = false;
+		lock.unlock();
+
+		condition.notify_all();
+	}
+}
@@ -0,0 +1,72 @@
+// Description: Contour lines written by the dedicated thread using double buffering
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef AsyncContourLinesSink_H
+#define AsyncContourLinesSink_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+#include "TVector.h"
+#include "PolylineStore.h"
+#include "ContourLinesSink.h"
+
+//Contour lines passed to the sinks (DXF, shapefile, CSV) by the dedicated writer thread
+//The smoothing thread copies each contour line into the filled buffer, the full buffer is swapped with the written one
+//and passed to the writer thread, which sends its contour lines to all sinks. The smoothing thread waits only when
+//the writer has not finished the previous buffer, the memory is bounded by two buffers, not by the amount of contour lines.
+//Exception thrown by the sink stops the writing, it is rethrown to the smoothing thread by addPolyline or close.
+class AsyncContourLinesSink : public ContourLinesSink
+{
+        private:
+                static const int BUFFER_VERTICES = 1 << 18;     //Vertices collected before the buffer is passed to the writer
+
+                TVector <ContourLinesSink*> sinks;              //Receivers of the contour lines, not owned
+                PolylineStore buffers[2];                       //Filled and written buffers
+                TVector <int> source_ids[2];                    //Source ids of the buffered contour lines
+                int buffer_vertices;                            //Vertices of the full buffer
+                int filled;                                     //Index of the buffer filled by the smoothing thread
+                bool pending;                                   //The other buffer is written by the writer thread
+                bool finished;                                  //No more buffers will be passed
+                std::exception_ptr error;                       //Exception thrown by the sink
+                std::mutex mutex;
+                std::condition_variable condition;
+                std::thread writer;
+
+        public:
+                AsyncContourLinesSink(const TVector <ContourLinesSink*>& sinks_, const int buffer_vertices_ = BUFFER_VERTICES);
+                AsyncContourLinesSink(const AsyncContourLinesSink&) = delete;
+                AsyncContourLinesSink& operator = (const AsyncContourLinesSink&) = delete;
+                ~AsyncContourLinesSink();
+
+        public:
+                void addPolyline(const PolylineSpan& polyline, const int source_id) override;
+                void close() override;
+
+        private:
+                void submit();
+                void stop();
+                void writeBuffers();
+};
+
+#endif
@@ -0,0 +1,94 @@
+// Description: LDLT factorization of the symmetric positive definite band matrix
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef BandedLDLT_H
+#define BandedLDLT_H
+
+#include <array>
+#include <span>
+#include <Eigen/Dense>
+#include <Eigen/Core>
+
+#include "TVector.h"
+
+//LDLT factorization of the symmetric positive definite band matrix A = L * D * L'
+//The band of L is stored row by row: L(i, i - p), ..., L(i, i - 1)
+//Factorization costs O(n * p^2), solution O(n * p) instead of the dense O(n^2) product with the inverse
+//
+//The matrix of the AXS system A = diag(w) + lambda1 * Dk' * Dk, Dk is the k-th difference matrix, is assembled
+//directly from the difference stencil. Kernels are generated for the half bandwidth p = k = 1, ..., MAX_SMOOTHING_ORDER,
+//the tridiagonal (k = 1) and pentadiagonal (k = 2) systems use dedicated fast paths.
+//The band of lambda1 * Dk' * Dk depends only on (n, lambda1, k): it is assembled once by analyzePattern,
+//factorize repeats only the numeric factorization for the new diagonal w (weighted and scaled versions).
+//Several right-hand sides (X and Y coordinates) stored row by row are solved in one sweep over the factor.
+template <typename T>
+class BandedLDLT
+{
+        private:
+                int n;                                  //Amount of rows
+                int p;                                  //Half bandwidth
+                T lambda;                               //Smoothing factor of the analyzed pattern
+                TVector <T> GL;                         //Subdiagonal part of lambda1 * Dk' * Dk, n * p items
+                TVector <T> GD;                         //Diagonal of lambda1 * Dk' * Dk, n items
+                TVector <T> L;                          //Subdiagonal part of the unit lower triangular matrix, n * p items
+                TVector <T> D;                          //Diagonal matrix, n items
+
+        public:
+                static const int MAX_SMOOTHING_ORDER = 5;
+
+                BandedLDLT() : n(0), p(0), lambda(0) {}
+                BandedLDLT(const TVector <T>& w, const T lambda1, const int k) : n(0), p(0), lambda(0) { compute(w, lambda1, k); }
+
+        public:
+                void compute(const TVector <T>& w, const T lambda1, const int k);
+                void analyzePattern(const int n_, const T lambda1, const int k);
+                void factorize(std::span <const T> w);
+                bool isPatternAnalyzed(const int n_, const T lambda1, const int k) const { return (n == n_) && (lambda == lambda1) && (p == k); }
+                Eigen::Matrix <T, Eigen::Dynamic, 1> solve(const Eigen::Matrix <T, Eigen::Dynamic, 1>& b) const;
+                Eigen::Matrix <T, Eigen::Dynamic, 2, Eigen::RowMajor> solve(const Eigen::Matrix <T, Eigen::Dynamic, 2, Eigen::RowMajor>& B) const;
+                void solveInPlace(Eigen::Ref <Eigen::Matrix <T, Eigen::Dynamic, 1> > x) const;
+                void solveInPlace(Eigen::Map <Eigen::Matrix <T, Eigen::Dynamic, 2, Eigen::RowMajor> > X) const;
+
+                int rows() const { return n; }
+                int bandwidth() const { return p; }
+
+        private:
+                template <int P>
+                static constexpr std::array <T, P + 1> getDifferenceStencil();
+
+                template <int P>
+                void assembleBand();
+
+                template <int P>
+                void factorizeBand();
+
+                template <int C>
+                void substitute(T* x) const;
+
+                template <int P, int C>
+                void substituteBand(T* x) const;
+
+                static void checkPivot(const T d, const int i);
+};
+
+#include "BandedLDLT.hpp"
+
+#endif
@@ -0,0 +1,383 @@
+// Description: LDLT factorization of the symmetric positive definite band matrix
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef BandedLDLT_HPP
+#define BandedLDLT_HPP
+
+#include <cmath>
+#include <string>
+#include <algorithm>
+
+#include "Const.h"
+#include "BadDataException.h"
+#include "MathZeroDevisionException.h"
+
+
+template <typename T>
+void BandedLDLT<T>::compute(const TVector <T>& w, const T lambda1, const int k)
+{
+	//Assemble and factorize A = diag(w) + lambda1 * Dk' * Dk, half bandwidth p = k
+	analyzePattern(w.size(), lambda1, k);
+	factorize(w);
+}
+
+
+template <typename T>
+void BandedLDLT<T>::analyzePattern(const int n_, const T lambda1, const int k)
+{
+	//Assemble the band of lambda1 * Dk' * Dk, half bandwidth p = k
+	n = n_;
+	p = k;
+	lambda = lambda1;
+
+	GL.assign(n * p, 0);
+	GD.assign(n, 0);
+
+	//Runtime dispatch to the kernels specialized for the smoothing order
+	switch (k)
+	{
+		case 1: assembleBand<1>(); break;
+		case 2: assembleBand<2>(); break;
+		case 3: assembleBand<3>(); break;
+		case 4: assembleBand<4>(); break;
+		case 5: assembleBand<5>(); break;
+
+		//Throw exception
+		default:
+			throw BadDataException("BadDataException: unsupported smoothing order, ", "k = " + std::to_string(k));
+	}
+}
+
+
+template <typename T>
+void BandedLDLT<T>::factorize(std::span <const T> w)
+{
+	//Numeric factorization of A = diag(w) + lambda1 * Dk' * Dk using the analyzed pattern
+	L = GL;
+	D.resize(n);
+
+	for (int i = 0; i < n; i++)
+		D[i] = GD[i] + w[i];
+
+	switch (p)
+	{
+		case 1: factorizeBand<1>(); break;
+		case 2: factorizeBand<2>(); break;
+		case 3: factorizeBand<3>(); break;
+		case 4: factorizeBand<4>(); break;
+		case 5: factorizeBand<5>(); break;
+	}
+}
+
+
+template <typename T>
+Eigen::Matrix <T, Eigen::Dynamic, 1> BandedLDLT<T>::solve(const Eigen::Matrix <T, Eigen::Dynamic, 1>& b) const
+{
+	//Solve A * x = b using L * D * L' factorization
+	Eigen::Matrix <T, Eigen::Dynamic, 1> x = b;
+	substitute<1>(x.data());
+
+	return x;
+}
+
+
+template <typename T>
+Eigen::Matrix <T, Eigen::Dynamic, 2, Eigen::RowMajor> BandedLDLT<T>::solve(const Eigen::Matrix <T, Eigen::Dynamic, 2, Eigen::RowMajor>& B) const
+{
+	//Solve A * X = B for both columns in one pass over L * D * L' factorization
+	Eigen::Matrix <T, Eigen::Dynamic, 2, Eigen::RowMajor> X = B;
+	substitute<2>(X.data());
+
+	return X;
+}
+
+
+template <typename T>
+void BandedLDLT<T>::solveInPlace(Eigen::Ref <Eigen::Matrix <T, Eigen::Dynamic, 1> > x) const
+{
+	//Solve A * x = b, the right-hand side b is overwritten by the solution
+	substitute<1>(x.data());
+}
+
+
+template <typename T>
+void BandedLDLT<T>::solveInPlace(Eigen::Map <Eigen::Matrix <T, Eigen::Dynamic, 2, Eigen::RowMajor> > X) const
+{
+	//Solve A * X = B for both columns, the right-hand sides B stored row by row are overwritten by the solution
+	substitute<2>(X.data());
+}
+
+
+template <typename T>
+template <int C>
+void BandedLDLT<T>::substitute(T* x) const
+{
+	//Runtime dispatch to the kernels specialized for the half bandwidth
+	switch (p)
+	{
+		case 1: substituteBand<1, C>(x); break;
+		case 2: substituteBand<2, C>(x); break;
+		case 3: substituteBand<3, C>(x); break;
+		case 4: substituteBand<4, C>(x); break;
+		case 5: substituteBand<5, C>(x); break;
+	}
+}
+
+
+template <typename T>
+template <int P>
+constexpr std::array <T, P + 1> BandedLDLT<T>::getDifferenceStencil()
+{
+	//Row of the P-th difference matrix: c(s) = (-1)^(P - s) * binomial(P, s)
+	std::array <T, P + 1> c{};
+	T b = 1;
+
+	for (int s = 0; s <= P; s++)
+	{
+		c[s] = ((P - s) % 2 ? -b : b);
+		b = b * (P - s) / (s + 1);
+	}
+
+	return c;
+}
+
+
+template <typename T>
+template <int P>
+void BandedLDLT<T>::assembleBand()
+{
+	//Assemble the lower band of lambda1 * Dk' * Dk
+	constexpr std::array <T, P + 1> c = getDifferenceStencil<P>();
+
+	//Interior stencil of Dk' * Dk: g(s) = sum c(t) * c(t - s)
+	std::array <T, P + 1> g{};
+	for (int s = 0; s <= P; s++)
+		for (int t = s; t <= P; t++)
+			g[s] += c[t] * c[t - s];
+
+	//Amount of rows of Dk
+	const int nr = n - P;
+
+	for (int i = 0; i < n; i++)
+	{
+		T* Li = GL.data() + i * P - i + P;
+
+		//Interior row: all rows of Dk touching column i are inside the matrix
+		if ((i >= P) && (i < nr))
+		{
+			GD[i] = lambda * g[0];
+
+			for (int s = 1; s <= P; s++)
+				Li[i - s] = lambda * g[s];
+		}
+
+		//First and last P rows
+		else
+		{
+			for (int s = 0; s <= std::min(P, i); s++)
+			{
+				const int j = i - s;
+				T a = 0;
+
+				for (int r = std::max(0, i - P); r <= std::min(j, nr - 1); r++)
+					a += c[i - r] * c[j - r];
+
+				if (s == 0)
+					GD[i] = lambda * a;
+				else
+					Li[j] = lambda * a;
+			}
+		}
+	}
+}
+
+
+template <typename T>
+template <int P>
+void BandedLDLT<T>::factorizeBand()
+{
+	//Factorize the assembled band in place, row by row
+	if (n == 0)
+		return;
+
+	checkPivot(D[0], 0);
+
+	//Tridiagonal matrix, L(i, i - 1) stored at L[i]
+	if constexpr (P == 1)
+	{
+		for (int i = 1; i < n; i++)
+		{
+			const T a = L[i];
+			const T l = a / D[i - 1];
+
+			L[i] = l;
+			D[i] -= l * a;
+
+			checkPivot(D[i], i);
+		}
+	}
+
+	//Pentadiagonal matrix, L(i, i - 2) stored at L[2i], L(i, i - 1) at L[2i + 1]
+	else if constexpr (P == 2)
+	{
+		if (n > 1)
+		{
+			const T a = L[3];
+			const T l = a / D[0];
+
+			L[3] = l;
+			D[1] -= l * a;
+
+			checkPivot(D[1], 1);
+		}
+
+		for (int i = 2; i < n; i++)
+		{
+			const T l2 = L[2 * i] / D[i - 2];
+			const T l1 = (L[2 * i + 1] - l2 * D[i - 2] * L[2 * i - 1]) / D[i - 1];
+
+			L[2 * i] = l2;
+			L[2 * i + 1] = l1;
+			D[i] -= l2 * l2 * D[i - 2] + l1 * l1 * D[i - 1];
+
+			checkPivot(D[i], i);
+		}
+	}
+
+	//General band
+	else
+	{
+		for (int i = 1; i < n; i++)
+		{
+			const int j0 = std::max(0, i - P);
+			T* Li = L.data() + i * P - i + P;
+
+			//Compute L(i, j), j < i
+			for (int j = j0; j < i; j++)
+			{
+				const T* Lj = L.data() + j * P - j + P;
+				T s = Li[j];
+
+				for (int m = std::max(j0, j - P); m < j; m++)
+					s -= Li[m] * D[m] * Lj[m];
+
+				Li[j] = s / D[j];
+			}
+
+			//Compute D(i)
+			T d = D[i];
+
+			for (int m = j0; m < i; m++)
+				d -= Li[m] * Li[m] * D[m];
+
+			checkPivot(d, i);
+
+			D[i] = d;
+		}
+	}
+}
+
+
+template <typename T>
+template <int P, int C>
+void BandedLDLT<T>::substituteBand(T* x) const
+{
+	//Forward substitution L * y = b, diagonal D * z = y, backward substitution L' * x = z
+	//Right-hand sides are stored row by row, x(i, c) = x[i * C + c]
+	if constexpr (P == 1)
+	{
+		for (int i = 1; i < n; i++)
+			for (int c = 0; c < C; c++)
+				x[i * C + c] -= L[i] * x[(i - 1) * C + c];
+
+		for (int i = 0; i < n; i++)
+			for (int c = 0; c < C; c++)
+				x[i * C + c] /= D[i];
+
+		for (int i = n - 1; i > 0; i--)
+			for (int c = 0; c < C; c++)
+				x[(i - 1) * C + c] -= L[i] * x[i * C + c];
+	}
+
+	else if constexpr (P == 2)
+	{
+		if (n > 1)
+			for (int c = 0; c < C; c++)
+				x[C + c] -= L[3] * x[c];
+
+		for (int i = 2; i < n; i++)
+			for (int c = 0; c < C; c++)
+				x[i * C + c] -= L[2 * i] * x[(i - 2) * C + c] + L[2 * i + 1] * x[(i - 1) * C + c];
+
+		for (int i = 0; i < n; i++)
+			for (int c = 0; c < C; c++)
+				x[i * C + c] /= D[i];
+
+		for (int i = n - 1; i > 1; i--)
+		{
+			for (int c = 0; c < C; c++)
+			{
+				x[(i - 1) * C + c] -= L[2 * i + 1] * x[i * C + c];
+				x[(i - 2) * C + c] -= L[2 * i] * x[i * C + c];
+			}
+		}
+
+		if (n > 1)
+			for (int c = 0; c < C; c++)
+				x[c] -= L[3] * x[C + c];
+	}
+
+	else
+	{
+		for (int i = 0; i < n; i++)
+		{
+			const T* Li = L.data() + i * P - i + P;
+
+			for (int m = std::max(0, i - P); m < i; m++)
+				for (int c = 0; c < C; c++)
+					x[i * C + c] -= Li[m] * x[m * C + c];
+		}
+
+		for (int i = 0; i < n; i++)
+			for (int c = 0; c < C; c++)
+				x[i * C + c] /= D[i];
+
+		for (int i = n - 1; i >= 0; i--)
+		{
+			const T* Li = L.data() + i * P - i + P;
+
+			for (int m = std::max(0, i - P); m < i; m++)
+				for (int c = 0; c < C; c++)
+					x[m * C + c] -= Li[m] * x[i * C + c];
+		}
+	}
+}
+
+
+template <typename T>
+void BandedLDLT<T>::checkPivot(const T d, const int i)
+{
+	//Matrix is not positive definite
+	if (fabs(d) < MIN_FLOAT)
+		throw MathZeroDevisionException <T>("MathZeroDevisionException: can not compute LDLT factorization, ", "zero pivot in row ", i);
+}
+
+#endif
@@ -0,0 +1,62 @@
+// Description: LRU cache of the banded LDLT factorizations of the AXS system
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef BandedLDLTCache_H
+#define BandedLDLTCache_H
+
+#include <map>
+#include <list>
+#include <tuple>
+#include <mutex>
+#include <memory>
+
+#include "BandedLDLT.h"
+
+//LRU cache of the factorizations of W + lambda1 * Dk' * Dk + 2 * lambda2 * E, W = E (non-weighted, non-scaled version)
+//The matrix depends only on (n, lambda1, lambda2, k), parts of the same length share one factorization
+//The cache is thread-safe and may be shared by all contour lines of the run
+template <typename T>
+class BandedLDLTCache
+{
+        private:
+                typedef std::tuple <int, T, T, int> TKey;
+                typedef std::list <std::pair <TKey, std::shared_ptr <const BandedLDLT <T> > > > TItems;
+
+                const unsigned int capacity;            //Maximum amount of stored factorizations
+                TItems items;                           //Factorizations, most recently used first
+                std::map <TKey, typename TItems::iterator> index;       //Key -> position in the list of factorizations
+                unsigned int hits;                      //Amount of found factorizations
+                unsigned int misses;                    //Amount of computed factorizations
+                mutable std::mutex mtx;
+
+        public:
+                BandedLDLTCache(const unsigned int capacity_ = 128) : capacity(capacity_), hits(0), misses(0) {}
+
+        public:
+                std::shared_ptr <const BandedLDLT <T> > get(const int n, const T lambda1, const T lambda2, const int k);
+
+                unsigned int getHits() const { std::lock_guard <std::mutex> lock(mtx); return hits; }
+                unsigned int getMisses() const { std::lock_guard <std::mutex> lock(mtx); return misses; }
+};
+
+#include "BandedLDLTCache.hpp"
+
+#endif
@@ -0,0 +1,71 @@
+// Description: LRU cache of the banded LDLT factorizations of the AXS system
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef BandedLDLTCache_HPP
+#define BandedLDLTCache_HPP
+
+
+template <typename T>
+std::shared_ptr <const BandedLDLT <T> > BandedLDLTCache<T>::get(const int n, const T lambda1, const T lambda2, const int k)
+{
+	//Get factorization from the cache, compute it, if not found
+	const TKey key(n, lambda1, lambda2, k);
+
+	{
+		std::lock_guard <std::mutex> lock(mtx);
+		auto it = index.find(key);
+
+		//Factorization found, move it to the front
+		if (it != index.end())
+		{
+			items.splice(items.begin(), items, it->second);
+			hits++;
+
+			return it->second->second;
+		}
+
+		misses++;
+	}
+
+	//Compute factorization outside the lock
+	std::shared_ptr <const BandedLDLT <T> > ldlt = std::make_shared <const BandedLDLT <T> >(TVector <T>(n, 1.0 + 2.0 * lambda2), lambda1, k);
+
+	std::lock_guard <std::mutex> lock(mtx);
+
+	//Factorization has been added by another thread meanwhile
+	if (index.find(key) != index.end())
+		return ldlt;
+
+	//Add factorization to the front
+	items.emplace_front(key, ldlt);
+	index[key] = items.begin();
+
+	//Remove the least recently used factorization
+	if (items.size() > capacity)
+	{
+		index.erase(items.back().first);
+		items.pop_back();
+	}
+
+	return ldlt;
+}
+
+#endif
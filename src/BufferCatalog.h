@@ -0,0 +1,66 @@
+// Description: Catalog of the buffer fragments sorted by height, spatial indices of the buffer pairs
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef BufferCatalog_H
+#define BufferCatalog_H
+
+#include <span>
+#include <map>
+#include <memory>
+
+#include "TVector.h"
+#include "PolylineStore.h"
+#include "SegmentRTree.h"
+#include "SegmentGrid.h"
+
+//Catalog of the buffer fragments h - dh (side 0) and h + dh (side 1) built once after loading
+//Heights of both sides are rounded to 2 decimal places and sorted, each height refers to the contiguous
+//range of views of its fragments formed by more than min_points vertices; heights without such fragments are skipped.
+//Contour lines receive read-only spans of the fragments, no fragment is copied.
+//The joint spatial index of the pair of heights (h - dh, h + dh) is built on the first request and shared
+//by all contour lines of the height.
+class BufferCatalog
+{
+        private:
+                static constexpr double HEIGHT_TOLERANCE = 0.005;       //Half of the rounding step of the heights
+
+                double dh;                                              //Buffer height
+                TVector <double> heights[2];                            //Sorted heights of the fragments
+                TVector <int> height_first[2];                          //First fragment of the height, heights + 1 items
+                TVector <PolylineSpan> fragments[2];                    //Fragments sorted by the height, then by the loading order
+
+                std::map <std::pair <int, int>, std::shared_ptr <SegmentRTree> > trees;    //R-trees of the pairs of heights
+                std::map <std::pair <int, int>, std::shared_ptr <SegmentGrid> > grids;     //Uniform grids of the pairs of heights
+
+        public:
+                BufferCatalog(const PolylineStore& buffers_dh1, const PolylineStore& buffers_dh2, const double dh_, const int min_points);
+
+        public:
+                int findHeight(const int side, const double h) const;
+                std::span <const PolylineSpan> getFragments(const int side, const int ih) const;
+                const SegmentRTree& getTree(const int ih1, const int ih2);
+                const SegmentGrid& getGrid(const int ih1, const int ih2);
+};
+
+#include "BufferCatalog.hpp"
+
+#endif
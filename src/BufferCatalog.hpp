@@ -0,0 +1,120 @@
+// Description: Catalog of the buffer fragments sorted by height, spatial indices of the buffer pairs
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef BufferCatalog_HPP
+#define BufferCatalog_HPP
+
+#include <cmath>
+#include <algorithm>
+
+#include "Round.h"
+
+
+inline BufferCatalog::BufferCatalog(const PolylineStore& buffers_dh1, const PolylineStore& buffers_dh2, const double dh_, const int min_points) : dh(dh_)
+{
+	//Create catalog of the buffer fragments of both sides
+	for (int side = 0; side < 2; side++)
+	{
+		const PolylineStore& buffers = (side == 0 ? buffers_dh1 : buffers_dh2);
+
+		//Rounded heights of the fragments formed by enough points
+		TVector <int> perm;
+		TVector <double> hr(buffers.size());
+
+		for (int i = 0; i < buffers.size(); i++)
+		{
+			hr[i] = Round::roundNumber(buffers[i].getZ(), 2);
+
+			if (buffers[i].size() > min_points)
+				perm.push_back(i);
+		}
+
+		//Sort fragments by the height, keep the loading order of the fragments of the same height
+		std::stable_sort(perm.begin(), perm.end(), [&hr](const int a, const int b) { return hr[a] < hr[b]; });
+
+		//Create views and the height table
+		fragments[side].reserve(perm.size());
+
+		for (const int i : perm)
+		{
+			if (heights[side].empty() || (hr[i] != heights[side].back()))
+			{
+				heights[side].push_back(hr[i]);
+				height_first[side].push_back(fragments[side].size());
+			}
+
+			fragments[side].push_back(buffers[i]);
+		}
+
+		height_first[side].push_back(fragments[side].size());
+	}
+}
+
+
+inline int BufferCatalog::findHeight(const int side, const double h) const
+{
+	//Find the height of the side within the tolerance, -1 if no such height exists
+	const TVector <double>& hs = heights[side];
+	auto it = std::lower_bound(hs.begin(), hs.end(), h - HEIGHT_TOLERANCE);
+
+	if ((it == hs.end()) || (*it > h + HEIGHT_TOLERANCE))
+		return -1;
+
+	//Take the closer one of two candidates
+	if ((it + 1 != hs.end()) && (fabs(*(it + 1) - h) < fabs(*it - h)))
+		++it;
+
+	return it - hs.begin();
+}
+
+
+inline std::span <const PolylineSpan> BufferCatalog::getFragments(const int side, const int ih) const
+{
+	//Get views of the fragments of the height
+	return std::span <const PolylineSpan>(fragments[side]).subspan(height_first[side][ih], height_first[side][ih + 1] - height_first[side][ih]);
+}
+
+
+inline const SegmentRTree& BufferCatalog::getTree(const int ih1, const int ih2)
+{
+	//Get R-tree of the pair of heights, create it if necessary
+	std::shared_ptr <SegmentRTree>& tree = trees[{ ih1, ih2 }];
+
+	if (!tree)
+		tree = std::make_shared <SegmentRTree>(getFragments(0, ih1), getFragments(1, ih2));
+
+	return *tree;
+}
+
+
+inline const SegmentGrid& BufferCatalog::getGrid(const int ih1, const int ih2)
+{
+	//Get uniform grid of the pair of heights, create it if necessary
+	std::shared_ptr <SegmentGrid>& grid = grids[{ ih1, ih2 }];
+
+	if (!grid)
+		grid = std::make_shared <SegmentGrid>(getFragments(0, ih1), getFragments(1, ih2), dh);
+
+	return *grid;
+}
+
+#endif
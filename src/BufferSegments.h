@@ -0,0 +1,85 @@
+// Description: Line segments of the buffer fragments, common part of the spatial indices
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef BufferSegments_H
+#define BufferSegments_H
+
+#include <tuple>
+#include <array>
+#include <span>
+
+#include "TVector.h"
+#include "PolylineStore.h"
+#include "SegmentArrays.h"
+
+//Line segments of the buffer fragments of both sides of the corridor stored as a structure of arrays
+//Each segment is tagged with its side: 0 for the buffer h - dh, 1 for the buffer h + dh.
+//One traversal of the spatial index returns the nearest segment of both sides.
+//Spatial indices reorder the segments, the storage position of any (side, buffer, segment) triple is kept.
+//Consecutive contour vertices have nearest points on the same fragment, the coherent query walks
+//along the fragment from the previous nearest segment while the distance decreases; the found
+//distance then bounds the search of the index.
+class BufferSegments
+{
+        public:
+                typedef std::tuple <int, int, double, double, double> TNearestPoint;   //Buffer index, segment index, distance, nearest point
+                typedef std::array <TNearestPoint, 2> TNearestPoints;                  //Nearest points of both sides
+
+        protected:
+                //Nearest segment found so far: storage position and squared distance
+                struct TNearestSegment
+                {
+                        int k;
+                        double d2;
+                };
+
+                typedef std::array <TNearestSegment, 2> TNearestSegments;
+
+                static constexpr double PRUNE_TOLERANCE = 1.0e-9;  //Relative tolerance of the pruning, keeps segments of the equal distance
+
+                SegmentArrays segments;                 //Segments in the storage order
+                TVector <int> buffs, idxs;              //Buffer fragment index and segment index inside the fragment
+                TVector <unsigned char> sides;          //Side of the segment
+                TVector <int> fragment_first;           //First segment of the fragment, fragments of both sides + 1 items
+                int fragment_offset[2];                 //First fragment of the side
+                TVector <int> positions;                //Storage position of the segment fragment_first[fragment_offset[side] + buff] + idx
+
+        public:
+                BufferSegments(std::span <const PolylineSpan> buffers_dh1, std::span <const PolylineSpan> buffers_dh2);
+
+        public:
+                int size() const { return segments.size(); }
+
+        protected:
+                void reorder(const TVector <int>& perm);
+                void updateNearestSegment(const int k, const double d2, TNearestSegments& nearest) const;
+                void updateNearestSegments(const int first, const int count, const double xq, const double yq, TNearestSegments& nearest) const;
+                TNearestSegments walkAlongFragments(const double xq, const double yq, const int buff1, const int idx1, const int buff2, const int idx2) const;
+                TNearestPoints getNearestPoints(const TNearestSegments& nearest, const double xq, const double yq) const;
+                static TNearestSegments getEmptyNearestSegments();
+                static bool isWithinDistance(const double d2, const unsigned char side_mask, const TNearestSegments& nearest);
+                double getX2(const int k) const { return segments.x1[k] + segments.ux[k]; }
+                double getY2(const int k) const { return segments.y1[k] + segments.uy[k]; }
+};
+
+#include "BufferSegments.hpp"
+
+#endif
@@ -0,0 +1,198 @@
+// Description: Line segments of the buffer fragments, common part of the spatial indices
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef BufferSegments_HPP
+#define BufferSegments_HPP
+
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+
+
+inline BufferSegments::BufferSegments(std::span <const PolylineSpan> buffers_dh1, std::span <const PolylineSpan> buffers_dh2)
+{
+	//Collect segments of all buffer fragments of both sides
+	fragment_first.push_back(0);
+
+	for (int side = 0; side < 2; side++)
+	{
+		const std::span <const PolylineSpan> buffers = (side == 0 ? buffers_dh1 : buffers_dh2);
+		fragment_offset[side] = fragment_first.size() - 1;
+
+		for (int j = 0; j < (int)buffers.size(); j++)
+		{
+			for (int i = 0; i + 1 < buffers[j].size(); i++)
+			{
+				segments.push_back(buffers[j].getX(i), buffers[j].getY(i), buffers[j].getX(i + 1), buffers[j].getY(i + 1));
+
+				buffs.push_back(j);
+				idxs.push_back(i);
+				sides.push_back(side);
+			}
+
+			fragment_first.push_back(segments.size());
+		}
+	}
+
+	//Segments are stored in the fragment order
+	positions.resize(segments.size());
+	std::iota(positions.begin(), positions.end(), 0);
+}
+
+
+inline void BufferSegments::reorder(const TVector <int>& perm)
+{
+	//Reorder stored segments, the k-th stored segment will be the perm[k]-th one
+	auto reorderVector = [&perm](auto& v)
+	{
+		auto vp = v;
+		for (int k = 0; k < (int)perm.size(); k++)
+			vp[k] = v[perm[k]];
+		v.swap(vp);
+	};
+
+	reorderVector(segments.x1); reorderVector(segments.y1);
+	reorderVector(segments.ux); reorderVector(segments.uy);
+	reorderVector(segments.iuu);
+	reorderVector(buffs); reorderVector(idxs); reorderVector(sides);
+
+	//Actualize storage positions
+	for (int k = 0; k < (int)perm.size(); k++)
+		positions[fragment_first[fragment_offset[sides[k]] + buffs[k]] + idxs[k]] = k;
+}
+
+
+inline void BufferSegments::updateNearestSegment(const int k, const double d2, TNearestSegments& nearest) const
+{
+	//Update minimum of the segment side, ties are resolved to the lowest (buffer, segment) pair, as in the sequential search
+	TNearestSegment& n = nearest[sides[k]];
+
+	if ((n.k < 0) || (d2 < n.d2) || ((d2 == n.d2) && ((buffs[k] < buffs[n.k]) || ((buffs[k] == buffs[n.k]) && (idxs[k] < idxs[n.k])))))
+	{
+		n.k = k;
+		n.d2 = d2;
+	}
+}
+
+
+inline void BufferSegments::updateNearestSegments(const int first, const int count, const double xq, const double yq, TNearestSegments& nearest) const
+{
+	//Test stored segments first, ..., first + count - 1 using the vectorized kernel
+	static const int BLOCK = 64;
+	double d2[BLOCK];
+
+	for (int k0 = first; k0 < first + count; k0 += BLOCK)
+	{
+		const int n = std::min(BLOCK, first + count - k0);
+		segments.getDistances2(k0, n, xq, yq, d2);
+
+		for (int i = 0; i < n; i++)
+			updateNearestSegment(k0 + i, d2[i], nearest);
+	}
+}
+
+
+inline BufferSegments::TNearestSegments BufferSegments::walkAlongFragments(const double xq, const double yq, const int buff1, const int idx1, const int buff2, const int idx2) const
+{
+	//Walk along the fragments of both sides from the given segments to the local minima of the distance
+	TNearestSegments nearest = getEmptyNearestSegments();
+
+	for (int side = 0; side < 2; side++)
+	{
+		const int buff = (side == 0 ? buff1 : buff2), idx = (side == 0 ? idx1 : idx2);
+		const int fragments = (side == 0 ? fragment_offset[1] : fragment_first.size() - 1) - fragment_offset[side];
+
+		//Invalid segment
+		if ((buff < 0) || (buff >= fragments) || (idx < 0))
+			continue;
+
+		const int i0 = fragment_first[fragment_offset[side] + buff], i1 = fragment_first[fragment_offset[side] + buff + 1];
+		int i_min = i0 + idx;
+
+		if (i_min >= i1)
+			continue;
+
+		updateNearestSegment(positions[i_min], segments.getDistance2(positions[i_min], xq, yq), nearest);
+
+		//Walk forward, then backward while the squared distance decreases
+		for (const int step : { 1, -1 })
+		{
+			for (int i = i_min + step; (i >= i0) && (i < i1); i += step)
+			{
+				const double d2 = segments.getDistance2(positions[i], xq, yq);
+
+				if (d2 >= nearest[side].d2)
+					break;
+
+				updateNearestSegment(positions[i], d2, nearest);
+				i_min = i;
+			}
+		}
+	}
+
+	return nearest;
+}
+
+
+inline BufferSegments::TNearestPoints BufferSegments::getNearestPoints(const TNearestSegments& nearest, const double xq, const double yq) const
+{
+	//Convert the nearest segments of both sides to buffer index, segment index, distance and the nearest point on the segment
+	TNearestPoints points;
+
+	for (int side = 0; side < 2; side++)
+	{
+		const int k = nearest[side].k;
+
+		if (k < 0)
+			points[side] = { -1, -1, 1.0e16, 0, 0 };
+
+		else
+		{
+			const auto [xi, yi] = segments.getNearestPoint(k, xq, yq);
+			points[side] = { buffs[k], idxs[k], sqrt(nearest[side].d2), xi, yi };
+		}
+	}
+
+	return points;
+}
+
+
+inline BufferSegments::TNearestSegments BufferSegments::getEmptyNearestSegments()
+{
+	//No segment found
+	return { TNearestSegment{ -1, std::numeric_limits<double>::max() }, TNearestSegment{ -1, std::numeric_limits<double>::max() } };
+}
+
+
+inline bool BufferSegments::isWithinDistance(const double d2, const unsigned char side_mask, const TNearestSegments& nearest)
+{
+	//May a region in the squared distance d2 containing segments of the given sides (bit mask) hold a closer segment?
+	for (int side = 0; side < 2; side++)
+	{
+		if ((side_mask & (1 << side)) && (d2 <= nearest[side].d2 * (1.0 + PRUNE_TOLERANCE)))
+			return true;
+	}
+
+	return false;
+}
+
+#endif
@@ -0,0 +1,89 @@
+// Description: Streaming CSV export of the simplified contour lines
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "CSVSink.h"
+
+#include <charconv>
+
+#include "FileWriteException.h"
+
+
+CSVSink::CSVSink(const std::string& file_name_) : file_name(file_name_), buffer(BUFFER_SIZE), used(0)
+{
+	//Open file
+	file.open(file_name, std::ios::out | std::ios::binary);
+
+	//Throw exception
+	if (!file.is_open())
+		throw FileWriteException("FileWriteException: can not write the file: ", file_name);
+}
+
+
+void CSVSink::addPolyline(const PolylineSpan& polyline, const int source_id)
+{
+	//Write rows "id x y z" of all vertices of the contour line
+	const double z = polyline.getZ();
+
+	for (int i = 0; i < polyline.size(); i++)
+	{
+		//Buffer is full
+		if (used + MAX_ROW_SIZE > buffer.size())
+			flush();
+
+		char* p = buffer.data() + used;
+		char* const last = buffer.data() + buffer.size();
+
+		p = std::to_chars(p, last, source_id).ptr;
+		*p++ = '\t';
+		p = std::to_chars(p, last, polyline.getX(i)).ptr;
+		*p++ = ' ';
+		p = std::to_chars(p, last, polyline.getY(i)).ptr;
+		*p++ = ' ';
+		p = std::to_chars(p, last, z).ptr;
+		*p++ = '\n';
+
+		used = p - buffer.data();
+	}
+}
+
+
+void CSVSink::close()
+{
+	//Write the rest of the buffer and close file
+	flush();
+	file.close();
+
+	//Throw exception
+	if (file.fail())
+		throw FileWriteException("FileWriteException: can not write the file: ", file_name);
+}
+
+
+void CSVSink::flush()
+{
+	//Write the buffer to the file
+	file.write(buffer.data(), used);
+	used = 0;
+
+	//Throw exception
+	if (file.fail())
+		throw FileWriteException("FileWriteException: can not write the file: ", file_name);
+}
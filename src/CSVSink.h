@@ -0,0 +1,59 @@
+// Description: Streaming CSV export of the simplified contour lines
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef CSVSink_H
+#define CSVSink_H
+
+#include <string>
+#include <fstream>
+
+#include "TVector.h"
+#include "PolylineStore.h"
+#include "ContourLinesSink.h"
+
+//Text file receiving the contour lines one by one, rows "id x y z" of all vertices
+//The layout equals the multiple polylines input (-m switch), the id is the source id of the contour line.
+//Coordinates are formatted by std::to_chars in the shortest exact form into the buffer written to the file when it is full.
+class CSVSink : public ContourLinesSink
+{
+        private:
+                static const int BUFFER_SIZE = 1 << 20;         //Size of the buffer in bytes
+                static const int MAX_ROW_SIZE = 128;            //Maximum length of the formatted row
+
+                std::string file_name;
+                std::ofstream file;
+                TVector <char> buffer;
+                std::size_t used;                               //Amount of used bytes of the buffer
+
+        public:
+                CSVSink(const std::string& file_name_);
+                CSVSink(const CSVSink&) = delete;
+                CSVSink& operator = (const CSVSink&) = delete;
+
+        public:
+                void addPolyline(const PolylineSpan& polyline, const int source_id) override;
+                void close() override;
+
+        private:
+                void flush();
+};
+
+#endif
@@ -122,4 +122,8 @@
 #define EPS_VAR 				1.0e-6
 #endif
 
+#ifndef MIN_POINT_DIST2				//Minimum squared planar distance of two consecutive polyline vertices, closer vertices are duplicate
+#define MIN_POINT_DIST2				0.001
+#endif
+
 #endif
\ No newline at end of file
@@ -21,22 +21,44 @@
 #ifndef ContourLinesSimplify_H
 #define ContourLinesSimplify_H
 
-#include <memory>
-#include <map>
+#include <tuple>
+#include <array>
+#include <span>
+#include <memory_resource>
 
-#include "TVector2D.h"
-#include "Point3D.h"
+#include "TVector.h"
+#include "PolylineStore.h"
+
+class SegmentArrays;
+class BufferCatalog;
+class ContourLinesSink;
+
+//Spatial index of the buffer segments used by the nearest neighbor search
+typedef enum
+{
+	RTreeIndex = 0,
+	GridIndex
+} TNearestNeighborsIndex;
 
 //Contour line simplification using potential and minimum energy splines
 class ContourLinesSimplify
 {
 	public:
-		static TVector2D < std::shared_ptr <Point3D > >  smoothContourLinesBySplineE(const TVector2D <std::shared_ptr <Point3D > >& contours, std::multimap <double, TVector < std::shared_ptr < Point3D > > >& contour_points_buffers_dz1, std::multimap <double, TVector < std::shared_ptr < Point3D > > >& contour_points_buffers_dz2, 
-			const double dh, const unsigned int min_points, const double lambda1, const double lambda2, const int ns, const int d, const bool weighted, const bool scaled);
-	private:	
-		static TVector2D <std::shared_ptr <Point3D > > splitContourLine (const TVector <std::shared_ptr <Point3D > > &c, const int np);
-		static std::tuple<TVector <int>, TVector <int>, TVector <float>, TVector <std::shared_ptr <Point3D > > > findNearestNeighbors(const TVector <std::shared_ptr <Point3D> >& qpoints, const TVector2D <std::shared_ptr <Point3D> >& buffers);
-		static std::tuple<int, double, double, double> getNearestLineSegmentPoint(const double xq, const double yq, const TVector <std::shared_ptr <Point3D > >& points);
+		static void smoothContourLinesBySplineE(const PolylineStore& contours, BufferCatalog& buffers,
+			const double dh, const int min_points, const double lambda1, const double lambda2, const int ns, const int d, const bool weighted, const bool scaled, const TNearestNeighborsIndex nn_index, ContourLinesSink& sink);
+		static void benchmarkNearestNeighbors(const PolylineStore& contours, BufferCatalog& buffers,
+			const double dh, const int min_points);
+	private:
+		//Nearest neighbors of the query points: buffer indices, segment indices, distances, coordinates of the nearest points
+		typedef std::tuple<std::pmr::vector <int>, std::pmr::vector <int>, std::pmr::vector <float>, std::pmr::vector <double>, std::pmr::vector <double> > TNearestNeighbors;
+
+		static int getContourPartEnd(const int n, const int first, const int np);
+		static TNearestNeighbors findNearestNeighbors(const PolylineSpan& qpoints, std::span <const PolylineSpan> buffers);
+
+		template <typename TIndex>
+		static std::array <TNearestNeighbors, 2> findNearestNeighbors(const PolylineSpan& qpoints, const TIndex& index, const bool coherent = true, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+		static std::tuple<int, double, double, double> getNearestLineSegmentPoint(const double xq, const double yq, const PolylineSpan& points);
+		static std::tuple<int, double, double, double> getNearestLineSegmentPoint(const double xq, const double yq, const SegmentArrays& segments);
 
 		
 }; 
@@ -25,136 +25,109 @@
 #include <memory>
 #include <map>
 #include <Eigen/Dense>                               
-#include <Eigen/Sparse>                              
 #include <Eigen/Core>
 
 #include "TVector.h"
-#include "TVector2D.h"
-#include "Point3D.h"
+#include "PolylineStore.h"
 #include "Const.h"
-#include "Round.h"
-#include "PointLineDistance.h"
+#include "SegmentArrays.h"
 #include "SplineSmoothing.h"
+#include "BandedLDLTCache.h"
+#include "BufferCatalog.h"
+#include "MonotonicArena.h"
+#include "ContourLinesSink.h"
 
-TVector2D < std::shared_ptr <Point3D > > ContourLinesSimplify::smoothContourLinesBySplineE(const TVector2D <std::shared_ptr <Point3D > >& contours, std::multimap <double, TVector < std::shared_ptr < Point3D > > >& contour_points_buffers_dh1, std::multimap <double, TVector < std::shared_ptr < Point3D > > >& contour_points_buffers_dh2, const double dh, const unsigned int min_points, const double lambda1, const double lambda2, const int ns, const int k, const bool weighted, const bool scaled)
+void ContourLinesSimplify::smoothContourLinesBySplineE(const PolylineStore& contours, BufferCatalog& buffers, const double dh, const int min_points, const double lambda1, const double lambda2, const int ns, const int k, const bool weighted, const bool scaled, const TNearestNeighborsIndex nn_index, ContourLinesSink& sink)
 {
 	//Simplify contour lines inside the corridor using the spline (Eigen version)
-	TVector2D <std::shared_ptr <Point3D > > contours_smoothed;
+	//Each smoothed contour line is passed to the sink with the index of the source contour line, the results are not kept
+	PolylineStore contour_smoothed;
 
 	const clock_t begin_time = clock();
-	int index = 0;
 
 	std::cout << "\n>>> PHASE: Smoothing contour lines \n\n";
 
-	//Precompute inverse matrix (non-scaled version)
-	Eigen::SparseMatrix <double> E0(ns, ns), W0(ns, ns), I0(ns, ns);
-	Eigen::SimplicialLDLT <Eigen::SparseMatrix<double> > solver(E0);
-	E0.setIdentity();  W0.setIdentity();
+	//Factorizations of W0 + lambda1 * D0' * D0 + 2 * lambda2 * E0, W0 = E0, shared by all contours (non-scaled version)
+	BandedLDLTCache <double> ldlt_cache;
 
-	const auto D0 = SplineSmoothing::diff(E0, k);
-	const auto D0T = D0.transpose();
-	solver.compute(W0 + lambda1 * D0T * D0 + 2.0 * lambda2 * E0);
-	I0 = solver.solve(E0);
+	//Solver reused by all parts of the weighted and scaled versions, the pattern is analyzed again only when the part length changes
+	BandedLDLT <double> ldlt;
+
+	//Arena of the temporaries of the processed part (nearest neighbors, weights, right-hand sides), reset after each part
+	MonotonicArena arena;
 
 	//Process all contour lines
-	for (auto c : contours)
+	for (int ic = 0; ic < contours.size(); ic++)
 	{
-		//Get height of the contour
-		const double h1 = c[0]->getZ() - dh;
-		const double h1r = Round::roundNumber(h1, 2);
-		const double h2 = c[0]->getZ() + dh;
-		const double h2r = Round::roundNumber(h2, 2);
+		const PolylineSpan c = contours[ic];
 
 		//Print h
-		std::cout << ">>> H = " << c[0]->getZ() << "m, n = " << c.size() << ":\n";
+		std::cout << ">>> H = " << c.getZ() << "m, n = " << c.size() << ":\n";
 
-		//Find corresponding buffer h - dh
-		TVector2D < std::shared_ptr<Point3D > > contour_points_buffer_dh1;
-		auto res1 = contour_points_buffers_dh1.equal_range(h1r);
+		//Find corresponding buffers h - dh, h + dh
+		const int ih1 = buffers.findHeight(0, c.getZ() - dh);
+		const int ih2 = buffers.findHeight(1, c.getZ() + dh);
 
-		///No buffer found
-		if (res1.first == res1.second)
+		//No buffer found
+		if ((ih1 < 0) || (ih2 < 0))
 			continue;
 
-		// Buffer h - dh already created
-		else
+		//Are there enough points?
+		if (c.size() > min_points)
 		{
-			//Copy buffer segments
-			for (auto it = res1.first; it != res1.second; ++it)
+			//Resulted contour line preallocated to its final size, parts share their end vertices and both copies are kept
+			int n_smoothed = 0;
+			for (int i = 0, j = 0; (ns > 0) && (i < c.size() - 1); i = j - 1)
 			{
-				if (it->second.size() > min_points)
-					contour_points_buffer_dh1.push_back(it->second);
+				j = getContourPartEnd(c.size(), i, ns);
+				n_smoothed += j - i;
 			}
-		}
 
-		//Find corresponding buffer h + dh
-		TVector2D < std::shared_ptr<Point3D > > contour_points_buffer_dh2;
-		auto res2 = contour_points_buffers_dh2.equal_range(h2r);
+			contour_smoothed.clear();
+			contour_smoothed.addPolyline(c.getZ(), n_smoothed);
 
-		///No buffer found
-		if (res2.first == res2.second)
-			continue;
+			//Get joint spatial index of both buffers, it is created by the first contour of the height
+			const SegmentRTree* tree = (nn_index == RTreeIndex ? &buffers.getTree(ih1, ih2) : NULL);
+			const SegmentGrid* grid = (nn_index == GridIndex ? &buffers.getGrid(ih1, ih2) : NULL);
 
-		// Buffer h + dh already created
-		else
-		{
-			//Copy buffer segments
-			for (auto it = res2.first; it != res2.second; ++it)
+			//Process parts of the contour line formed by ns points, parts are views of the contour line
+			for (int i = 0, j = 0, offset = 0; (ns > 0) && (i < c.size() - 1); offset += j - i, i = j - 1)
 			{
-				if (it->second.size() > min_points)
-					contour_points_buffer_dh2.push_back(it->second);
-			}
-		}
+				j = getContourPartEnd(c.size(), i, ns);
 
-		//Are there enough points?
-		if ((c.size() > min_points) && (contour_points_buffers_dh1.size() > 0) && (contour_points_buffers_dh2.size() > 0))
-		{
-			//Resulted contour line
-			TVector  <std::shared_ptr <Point3D > > contour_smoothed;
+				//Release temporaries of the previous part
+				arena.reset();
 
-			//Split contour line to parts formed by n points
-			const TVector2D  <std::shared_ptr <Point3D > > cparts = splitContourLine(c, ns);
+				const PolylineSpan cp = c.subspan(i, j - i);
+				const int n = cp.size();
 
-			//Process parts of the contour line
-			for (auto cp : cparts)
-			{
 				std::cout << ".";
-				int n = cp.size();
 
-				//Find NN to contour line vertices
-				const auto [nn_buffs1, nn_idxs1, nn_dist1, nn_points1] = findNearestNeighbors(cp, contour_points_buffer_dh1);
-				const auto [nn_buffs2, nn_idxs2, nn_dist2, nn_points2] = findNearestNeighbors(cp, contour_points_buffer_dh2);
+				//Find NN to contour line vertices in both buffers
+				const auto [nn1, nn2] = (nn_index == RTreeIndex ? findNearestNeighbors(cp, *tree, true, &arena) : findNearestNeighbors(cp, *grid, true, &arena));
+				const auto& [nn_buffs1, nn_idxs1, nn_dist1, nn_x1, nn_y1] = nn1;
+				const auto& [nn_buffs2, nn_idxs2, nn_dist2, nn_x2, nn_y2] = nn2;
 
-				//Create supplementary matrices
-				Eigen::SparseMatrix <double> X(n, 1), Y(n, 1), X1(n, 1), Y1(n, 1), X2(n, 1), Y2(n, 1), W(n, n);
-				W.setIdentity();
-
-				for (int i = 0; i < n; i++)
-				{
-					X.insert(i, 0) = cp[i]->getX();
-					Y.insert(i, 0) = cp[i]->getY();
-
-					X1.insert(i, 0) = nn_points1[i]->getX();
-					Y1.insert(i, 0) = nn_points1[i]->getY();
-
-					X2.insert(i, 0) = nn_points2[i]->getX();
-					Y2.insert(i, 0) = nn_points2[i]->getY();
-				}
+				//Coordinate vectors mapped to the stored coordinates, no copy
+				const Eigen::Map <const Eigen::VectorXd> X(cp.getXData(), n), Y(cp.getYData(), n);
+				const Eigen::Map <const Eigen::VectorXd> X1(nn_x1.data(), n), Y1(nn_y1.data(), n), X2(nn_x2.data(), n), Y2(nn_y2.data(), n);
+				std::pmr::vector <double> w(n, 1.0, &arena);
+				Eigen::Map <Eigen::VectorXd> W(w.data(), n);
 
 				//Compute weights
 				if (weighted)
 				{
-					for (int i = 1; i < n - 1; i++)
+					for (int iv = 1; iv < n - 1; iv++)
 					{
 						//K points forward and backward
-						const int i0 = std::max(0, i - 5);
-						const int i2 = std::min(n - 1, i + 5);
+						const int i0 = std::max(0, iv - 5);
+						const int i2 = std::min(n - 1, iv + 5);
 
 						//Coordinate differences
-						const double dx1 = cp[i0]->getX() - cp[i]->getX();
-						const double dy1 = cp[i0]->getY() - cp[i]->getY();
-						const double dx2 = cp[i2]->getX() - cp[i]->getX();
-						const double dy2 = cp[i2]->getY() - cp[i]->getY();
+						const double dx1 = cp.getX(i0) - cp.getX(iv);
+						const double dy1 = cp.getY(i0) - cp.getY(iv);
+						const double dx2 = cp.getX(i2) - cp.getX(iv);
+						const double dy2 = cp.getY(i2) - cp.getY(iv);
 
 						//Norms
 						const double n1 = sqrt(dx1 * dx1 + dy1 * dy1);
@@ -165,44 +138,29 @@ TVector2D < std::shared_ptr <Point3D > > ContourLinesSimplify::smoothContourLine
 						const double om = acos(arg);
 
 						//Weight
-						const double w = sin(0.5 * om);
-						W.insert(i, i) = w * w;
+						const double wi = sin(0.5 * om);
+						W(iv) = wi * wi;
 					}
 				}
 
-				//Perform partial displacement
-				Eigen::SparseMatrix <double> XS(n, 1), YS(n, 1);
+				//Perform partial displacement, the solution is written into the resulted contour line
+				Eigen::Map <Eigen::VectorXd> XS(contour_smoothed.getXData(0) + offset, n), YS(contour_smoothed.getYData(0) + offset, n);
 
 				//Scaled asymetric least squares
 				if (scaled)
-				{
-					const auto [XST, YST] = SplineSmoothing::smoothPolylineInCorridorAsLSS(X, Y, X1, Y1, X2, Y2, W, lambda1, lambda2, k);
-					XS = XST; YS = YST;
-				}
+					SplineSmoothing::smoothPolylineInCorridorAsLSS <double>(X, Y, X1, Y1, X2, Y2, W, ldlt, lambda1, lambda2, k, XS, YS, &arena);
 
-				//Asymetric least squares
-				else
-				{
-					const auto [XST, YST] = weighted ? SplineSmoothing::smoothPolylineInCorridorAsLS(X, Y, X1, Y1, X2, Y2, W, lambda1, lambda2, k) : SplineSmoothing::smoothPolylineInCorridorAsLS(X, Y, X1, Y1, X2, Y2, W, I0, lambda1, lambda2, k);
-					XS = XST; YS = YST;
-				}
-				
-				//Convert matrices to points
-				TVector < std::shared_ptr<Point3D > > cps;
-				for (int i = 0; i < n; i++)
-				{
-					//Create point
-					std::shared_ptr <Point3D> p = std::make_shared <Point3D>(XS.coeff(i, 0), YS.coeff(i, 0), cp[i]->getZ());
-
-					//Add to the list
-					cps.push_back(p);
-				}
+				//Weighted asymetric least squares
+				else if (weighted)
+					SplineSmoothing::smoothPolylineInCorridorAsLS <double>(X, Y, X1, Y1, X2, Y2, W, ldlt, lambda1, lambda2, k, XS, YS, &arena);
 
-				//Add simplified contour to the list of contours
-				contour_smoothed.insert(std::end(contour_smoothed), std::begin(cps), std::end(cps));
+				//Asymetric least squares, shared factorization
+				else
+					SplineSmoothing::smoothPolylineInCorridorAsLS <double>(X, Y, X1, Y1, X2, Y2, W, ldlt_cache, lambda1, lambda2, k, XS, YS, &arena);
 			}
 
-			contours_smoothed.push_back(contour_smoothed);
+			//Pass the smoothed contour line to the sink
+			sink.addPolyline(contour_smoothed[0], ic);
 
 			std::cout << '\n';
 		}
@@ -211,102 +169,233 @@ TVector2D < std::shared_ptr <Point3D > > ContourLinesSimplify::smoothContourLine
 	std::cout << "OK";
 	std::cout << float(clock() - begin_time) / CLOCKS_PER_SEC;
 
-	return contours_smoothed;
+	//Print statistics of the factorization cache
+	if (!weighted && !scaled)
+		std::cout << "\n  Factorization cache: hits = " << ldlt_cache.getHits() << ", misses = " << ldlt_cache.getMisses() << '\n';
+
+	//Print statistics of the arena: allocations of the temporaries and heap allocations per part
+	if (arena.getResets() > 0)
+		std::cout << "\n  Part temporaries: parts = " << arena.getResets() << ", allocations per part = " << double(arena.getAllocations()) / arena.getResets() <<
+			", heap allocations per part = " << double(arena.getHeapAllocations()) / arena.getResets() << '\n';
 }
 
 
-TVector2D <std::shared_ptr <Point3D > > ContourLinesSimplify::splitContourLine(const TVector <std::shared_ptr <Point3D > >& c, const int np)
+void ContourLinesSimplify::benchmarkNearestNeighbors(const PolylineStore& contours, BufferCatalog& buffers, const double dh, const int min_points)
 {
-	//Split long contour line to shorter segments of the length np
-	TVector2D <std::shared_ptr <Point3D > > contours;
+	//Compare the sequential nearest neighbor search, the R-tree and the uniform grid
+	//All contour line vertices are queried against both buffers, joint indices are built once per pair of buffer heights
+	double t_bf = 0, t_tree_build = 0, t_grid_build = 0, t_tree_query[2] = { 0, 0 }, t_grid_query[2] = { 0, 0 };
+	int n_queries = 0, n_diff_tree[2] = { 0, 0 }, n_diff_grid[2] = { 0, 0 };
 
-	//Zero length 
-	if (np == 0)
-		return contours;
+	std::cout << "\n>>> PHASE: Benchmark of the nearest neighbor search \n\n";
 
-	//Splitting procedure
-	for (size_t i = 0; i < c.size() - 1; )
+	//Process all contour lines
+	for (int ic = 0; ic < contours.size(); ic++)
 	{
-		//Create new index
-		size_t j = std::min(i + np, c.size());
+		const PolylineSpan c = contours[ic];
+
+		if (c.size() <= min_points)
+			continue;
 
-		//Avoid to remain short last segment
-		if (c.size() - i < 1.25 * np)
-			j = c.size();
+		//Find both buffers h - dh, h + dh
+		const int ih1 = buffers.findHeight(0, c.getZ() - dh);
+		const int ih2 = buffers.findHeight(1, c.getZ() + dh);
+
+		if ((ih1 < 0) || (ih2 < 0))
+			continue;
 
-		//Copy np elements
-		TVector <std::shared_ptr <Point3D > > cp(c.cbegin() + i, c.cbegin() + j);
+		const std::span <const PolylineSpan> buffer1 = buffers.getFragments(0, ih1), buffer2 = buffers.getFragments(1, ih2);
 
-		//Copy part of the contour
-		contours.push_back(cp);
+		//Sequential search, one pass per buffer
+		clock_t t = clock();
+		const auto nn_bf1 = findNearestNeighbors(c, buffer1);
+		const auto nn_bf2 = findNearestNeighbors(c, buffer2);
+		t_bf += float(clock() - t) / CLOCKS_PER_SEC;
 
-		//Assign j
-		i = j - 1;
+		//Get joint indices of the pair of buffer heights, the first contour of the height builds them
+		t = clock();
+		const SegmentRTree& tree = buffers.getTree(ih1, ih2);
+		t_tree_build += float(clock() - t) / CLOCKS_PER_SEC;
+
+		t = clock();
+		const SegmentGrid& grid = buffers.getGrid(ih1, ih2);
+		t_grid_build += float(clock() - t) / CLOCKS_PER_SEC;
+
+		//Independent (0) and coherent (1) queries
+		for (int m = 0; m < 2; m++)
+		{
+			//R-tree search
+			t = clock();
+			const auto nn_tree = findNearestNeighbors(c, tree, m == 1);
+			t_tree_query[m] += float(clock() - t) / CLOCKS_PER_SEC;
+
+			//Uniform grid search
+			t = clock();
+			const auto nn_grid = findNearestNeighbors(c, grid, m == 1);
+			t_grid_query[m] += float(clock() - t) / CLOCKS_PER_SEC;
+
+			//Compare nearest segments of both buffers
+			for (int b = 0; b < 2; b++)
+			{
+				const auto& [nn_buffs, nn_idxs, nn_dists, nn_x, nn_y] = (b == 0 ? nn_bf1 : nn_bf2);
+				const auto& [nn_buffs_tree, nn_idxs_tree, nn_dists_tree, nn_x_tree, nn_y_tree] = nn_tree[b];
+				const auto& [nn_buffs_grid, nn_idxs_grid, nn_dists_grid, nn_x_grid, nn_y_grid] = nn_grid[b];
+
+				for (int i = 0; i < c.size(); i++)
+				{
+					n_diff_tree[m] += (nn_buffs_tree[i] != nn_buffs[i]) || (nn_idxs_tree[i] != nn_idxs[i]);
+					n_diff_grid[m] += (nn_buffs_grid[i] != nn_buffs[i]) || (nn_idxs_grid[i] != nn_idxs[i]);
+				}
+			}
+		}
+
+		n_queries += 2 * c.size();
 	}
 
-	return contours;
+	//Print results
+	std::cout << "  Queries = " << n_queries << '\n' <<
+		"  Sequential: query = " << t_bf << "s\n" <<
+		"  R-tree: build = " << t_tree_build << "s, query = " << t_tree_query[0] << "s, coherent query = " << t_tree_query[1] << "s, different = " << n_diff_tree[0] << ", " << n_diff_tree[1] << '\n' <<
+		"  Uniform grid: build = " << t_grid_build << "s, query = " << t_grid_query[0] << "s, coherent query = " << t_grid_query[1] << "s, different = " << n_diff_grid[0] << ", " << n_diff_grid[1] << '\n';
+}
+
+
+int ContourLinesSimplify::getContourPartEnd(const int n, const int first, const int np)
+{
+	//Split long contour line of n vertices to shorter parts of the length np
+	//Get the end (exclusive) of the part starting at first, the next part starts at its last vertex
+	int last = std::min(first + np, n);
+
+	//Avoid to remain short last segment
+	if (n - first < 1.25 * np)
+		last = n;
+
+	return last;
 }
 
 
-std::tuple<TVector <int>, TVector <int>, TVector <float>, TVector <std::shared_ptr <Point3D > > > ContourLinesSimplify::findNearestNeighbors(const TVector <std::shared_ptr <Point3D> >& qpoints, const TVector2D <std::shared_ptr <Point3D> >& buffers)
+ContourLinesSimplify::TNearestNeighbors ContourLinesSimplify::findNearestNeighbors(const PolylineSpan& qpoints, std::span <const PolylineSpan> buffers)
 {
 	//Find nearest neighbor to any contour line vertex
 	const int n = qpoints.size();
 
-	TVector <int> nn_buffs(n, -1), nn_idxs(n, -1);
-	TVector <float> nn_dists(n, MAX_FLOAT);
-	TVector <std::shared_ptr <Point3D > > nn_points(n);
+	std::pmr::vector <int> nn_buffs(n, -1), nn_idxs(n, -1);
+	std::pmr::vector <float> nn_dists(n, MAX_FLOAT);
+	std::pmr::vector <double> nn_x(n), nn_y(n);
+
+	//Segments of all buffer fragments
+	TVector <SegmentArrays> segments(buffers.size());
+
+	for (int j = 0; j < (int)buffers.size(); j++)
+	{
+		segments[j].reserve(buffers[j].size());
+
+		for (int i = 0; i + 1 < buffers[j].size(); i++)
+			segments[j].push_back(buffers[j].getX(i), buffers[j].getY(i), buffers[j].getX(i + 1), buffers[j].getY(i + 1));
+	}
 
 	//Process all query points
 	for (int i = 0; i < n; i++)
 	{
 		//Process all buffer fragments
-		for (int j = 0; j < buffers.size(); j++)
+		for (int j = 0; j < (int)buffers.size(); j++)
 		{
 			//Find nearest point on the segment
-			const auto [i_nn, d_nn, xi_nn, yi_nn] = getNearestLineSegmentPoint(qpoints[i]->getX(), qpoints[i]->getY(), buffers[j]);
+			const auto [i_nn, d_nn, xi_nn, yi_nn] = getNearestLineSegmentPoint(qpoints.getX(i), qpoints.getY(i), segments[j]);
 
 			//Update minimum
 			if (d_nn < nn_dists[i])
 			{
-				//Create nearest point
-				std::shared_ptr <Point3D> p_min = std::make_shared<Point3D>(xi_nn, yi_nn);
-
 				//Actualize lists of neighbors and their indices
 				nn_buffs[i] = j;
 				nn_idxs[i] = i_nn;
 				nn_dists[i] = d_nn;
-				nn_points[i] = p_min;
+				nn_x[i] = xi_nn;
+				nn_y[i] = yi_nn;
 			}
 		}
 	}
 
-	return { nn_buffs, nn_idxs, nn_dists, nn_points };
+	return { std::move(nn_buffs), std::move(nn_idxs), std::move(nn_dists), std::move(nn_x), std::move(nn_y) };
 }
 
 
-std::tuple<int, double, double, double> ContourLinesSimplify::getNearestLineSegmentPoint(const double xq, const double yq, const TVector <std::shared_ptr <Point3D > >& points)
+template <typename TIndex>
+std::array <ContourLinesSimplify::TNearestNeighbors, 2> ContourLinesSimplify::findNearestNeighbors(const PolylineSpan& qpoints, const TIndex& index, const bool coherent, std::pmr::memory_resource* memory)
 {
-	//Get nearest point on the line segments
-	int i_min = -1;
-	double d_min = 1.0e16, xi_min = 0, yi_min = 0;
+	//Find nearest neighbors to any contour line vertex in both buffers using one traversal of the joint spatial index
+	//Nearest points of consecutive vertices advance along the same fragments: coherent queries start from the previous nearest segments
+	//Results are allocated from the given memory resource
+	const int n = qpoints.size();
+
+	auto createNearestNeighbors = [n, memory]()
+	{
+		return TNearestNeighbors(std::pmr::vector <int>(n, -1, memory), std::pmr::vector <int>(n, -1, memory), std::pmr::vector <float>(n, MAX_FLOAT, memory),
+			std::pmr::vector <double>(n, memory), std::pmr::vector <double>(n, memory));
+	};
+
+	std::array <TNearestNeighbors, 2> nn = { createNearestNeighbors(), createNearestNeighbors() };
+
+	auto& [nn_buffs1, nn_idxs1, nn_dists1, nn_x1, nn_y1] = nn[0];
+	auto& [nn_buffs2, nn_idxs2, nn_dists2, nn_x2, nn_y2] = nn[1];
 
-	//Check all line segments
-	for (int i = 0; i < points.size() - 1; i++)
+	//Process all query points
+	for (int i = 0; i < n; i++)
 	{
-		double xi, yi;
-		const double d = PointLineDistance::getPointLineSegmentDistance2D(xq, yq, points[i]->getX(), points[i]->getY(), points[i + 1]->getX(), points[i + 1]->getY(), xi, yi);
+		//Find nearest segments of both buffers
+		const BufferSegments::TNearestPoints nearest = ((coherent && (i > 0) && (nn_buffs1[i - 1] >= 0 || nn_buffs2[i - 1] >= 0)) ?
+			index.findNearestSegments(qpoints.getX(i), qpoints.getY(i), nn_buffs1[i - 1], nn_idxs1[i - 1], nn_buffs2[i - 1], nn_idxs2[i - 1]) :
+			index.findNearestSegments(qpoints.getX(i), qpoints.getY(i)));
 
-		//Update minimum
-		if (d < d_min)
+		for (int s = 0; s < 2; s++)
 		{
-			i_min = i;
-			d_min = d;
-			xi_min = xi; yi_min = yi;
+			const auto [j_nn, i_nn, d_nn, xi_nn, yi_nn] = nearest[s];
+
+			//No segment found
+			if (j_nn < 0)
+				continue;
+
+			//Actualize lists of neighbors and their indices
+			auto& [nn_buffs, nn_idxs, nn_dists, nn_x, nn_y] = nn[s];
+
+			nn_buffs[i] = j_nn;
+			nn_idxs[i] = i_nn;
+			nn_dists[i] = d_nn;
+			nn_x[i] = xi_nn;
+			nn_y[i] = yi_nn;
 		}
 	}
 
-	return { i_min, d_min, xi_min, yi_min };
+	return nn;
+}
+
+
+std::tuple<int, double, double, double> ContourLinesSimplify::getNearestLineSegmentPoint(const double xq, const double yq, const PolylineSpan& points)
+{
+	//Get nearest point on the line segments
+	SegmentArrays segments;
+	segments.reserve(points.size());
+
+	for (int i = 0; i + 1 < points.size(); i++)
+		segments.push_back(points.getX(i), points.getY(i), points.getX(i + 1), points.getY(i + 1));
+
+	return getNearestLineSegmentPoint(xq, yq, segments);
+}
+
+
+std::tuple<int, double, double, double> ContourLinesSimplify::getNearestLineSegmentPoint(const double xq, const double yq, const SegmentArrays& segments)
+{
+	//Get nearest point on the line segments, squared distances are computed by the vectorized kernel
+	const auto [i_min, d2_min] = segments.findNearestSegment(0, segments.size(), xq, yq);
+
+	//No segment
+	if (i_min < 0)
+		return { -1, 1.0e16, 0, 0 };
+
+	//Nearest point and distance
+	const auto [xi_min, yi_min] = segments.getNearestPoint(i_min, xq, yq);
+
+	return { i_min, sqrt(d2_min), xi_min, yi_min };
 }
 
 
@@ -0,0 +1,40 @@
+// Description: Interface of the consumers of the simplified contour lines
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ContourLinesSink_H
+#define ContourLinesSink_H
+
+#include "PolylineStore.h"
+
+//Consumer of the simplified contour lines (DXF, shapefile, CSV writers)
+//Contour lines are passed one by one as soon as they are smoothed, the sink must not keep the view of the polyline.
+//The source id is the index of the contour line in the input data.
+class ContourLinesSink
+{
+        public:
+                virtual ~ContourLinesSink() {}
+
+        public:
+                virtual void addPolyline(const PolylineSpan& polyline, const int source_id) = 0;
+                virtual void close() = 0;
+};
+
+#endif
@@ -22,35 +22,98 @@
 #ifndef DXFExport_H
 #define DXFExport_H
 
-#include <memory>
+#include <string>
 
 #include "TVector.h"
-#include "TVector2D.h"
+#include "PolylineStore.h"
+#include "DXFWriter.h"
+
+//Entities representing the exported polylines
+typedef enum
+{
+	DXFLines = 0,		//LINE per segment
+	DXFLWPolylines,		//LWPOLYLINE per polyline, written to the R2000 (AC1015) file
+	DXFPolylines		//POLYLINE followed by VERTEX entities, readable by AC1006 consumers
+} TDXFEntityType;
+
 
 //Export contour lines to DXF file
+//Group codes and values are written by the buffered DXFWriter, ASCII or binary DXF share the same entities
+//LINE and POLYLINE entities are written to the AC1006 file without handles. LWPOLYLINE requires the R2000 file:
+//handles of all objects, subclass markers, BLOCK_RECORD table, model and paper space blocks and the OBJECTS section.
 class DXFExport
 {
         public:
-              
-		template <typename T>
-		static void exportContourLinesToDXF(const std::string &file_name, TVector2D <std::shared_ptr <Point3D > > contours_polylines, const T font_height);
+		//Streamed export: sections preceding the entities, entities of one contour line, end of the file
+		//The handle of the next entity is returned by beginContourLines() and advanced by createContourLine()
+		static unsigned int beginContourLines(DXFWriter & file, const TDXFEntityType entity_type);
+		static void createContourLine(DXFWriter & file, const PolylineSpan& polyline, const TDXFEntityType entity_type, unsigned int & handle);
+		static void endContourLines(DXFWriter & file, const TDXFEntityType entity_type);
+
+		//Binary group codes have 2 bytes in R2000 (LWPOLYLINE), 1 byte in AC1006
+		static int getGroupCodeSize(const TDXFEntityType entity_type) { return entity_type == DXFLWPolylines ? 2 : 1; }
 
         private:
+		inline static const std::string LAYER_CONTOURS = "contour_lines";		//Layer of the contour lines
+		inline static const std::string LAYER_CONTOURS_POINTS = "contour_lines_points";	//Layer of the contour lines labels
+		static const unsigned int COLOR_CONTOURS = 1;
+		static const unsigned int COLOR_CONTOURS_POINTS = 5;
+
+		//Handles of the R2000 objects preceding the entities
+		typedef enum
+		{
+			VPortTableHandle = 1,
+			LTypeTableHandle,
+			LayerTableHandle,
+			StyleTableHandle,
+			ViewTableHandle,
+			UCSTableHandle,
+			AppIdTableHandle,
+			DimStyleTableHandle,
+			BlockRecordTableHandle,
+			ByBlockHandle,
+			ByLayerHandle,
+			ContinuousHandle,
+			Layer0Handle,
+			LayerContoursHandle,
+			LayerContoursPointsHandle,
+			StandardStyleHandle,
+			AcadAppIdHandle,
+			StandardDimStyleHandle,
+			ModelSpaceHandle,
+			PaperSpaceHandle,
+			ModelSpaceBlockHandle,
+			ModelSpaceEndBlockHandle,
+			PaperSpaceBlockHandle,
+			PaperSpaceEndBlockHandle,
+			RootDictionaryHandle,
+			GroupDictionaryHandle,
+			FirstEntityHandle
+		} THandle;
 
-                static void createHeaderSection (std::ofstream & file);
-                static void createTableSection (std::ofstream & file);
-                static void endTableSection (std::ofstream & file);
-                static void createLayerSection (std::ofstream & file, const std::string &layer_name, const unsigned int color );
-                static void createEntitySection (std::ofstream & file);
-		static void endHeaderSection(std::ofstream & file);
+		//Entities are streamed, $HANDSEED written in the header is above the handles of all entities
+		static const unsigned int HANDLE_SEED = 0x7FFFFFFF;
+
+                static void createHeaderSection (DXFWriter & file, const TDXFEntityType entity_type);
+                static void createTableSection (DXFWriter & file);
+                static void endTableSection (DXFWriter & file);
+                static void createLayerSection (DXFWriter & file, const std::string &layer_name, const unsigned int color );
+                static void createEntitySection (DXFWriter & file);
+		static void endHeaderSection(DXFWriter & file);
+
+		static void createTablesR2000(DXFWriter & file);
+		static void createTable(DXFWriter & file, const std::string &table_name, const unsigned int handle, const int count);
+		static void createTableRecord(DXFWriter & file, const std::string &record_type, const std::string &subclass, const unsigned int handle, const unsigned int table_handle, const std::string &name);
+		static void createBlock(DXFWriter & file, const std::string &block_name, const unsigned int handle, const unsigned int end_handle, const unsigned int owner_handle, const bool paper_space);
+		static void createObjectsSection(DXFWriter & file);
 
                 template <typename T>
-                static void createLine (std::ofstream & file, const std::string &layer_name, const T x1, const T y1, const T z1, const T x2, const T y2, const T z2, const int color);
-		
-		static void processPolyline(std::ofstream & file, TVector <std::shared_ptr<Point3D > > polyline, const std::string &layer_name, const unsigned int color);
+                static void createLine (DXFWriter & file, const std::string &layer_name, const T x1, const T y1, const T z1, const T x2, const T y2, const T z2, const int color);
 
-		template <typename T>
-		static std::string to_string(const T value, const unsigned short dec_places);
+		static void createLWPolyline(DXFWriter & file, const PolylineSpan& polyline, const std::string &layer_name, const int color, const unsigned int handle);
+		static void createPolyline(DXFWriter & file, const PolylineSpan& polyline, const std::string &layer_name, const int color);
+		
+		static void processPolyline(DXFWriter & file, const PolylineSpan& polyline, const std::string &layer_name, const unsigned int color, const TDXFEntityType entity_type, unsigned int & handle);
 
 };
 
@@ -23,279 +23,423 @@
 #ifndef DXFExport_HPP
 #define DXFExport_HPP
 
-#include <cstring>
-#include <cstdlib>
-#include <fstream>
-#include <iomanip>
-#include <sstream>
-
+#include <tuple>
+#include <utility>
 
 #include "Const.h"
-#include "Point3D.h"
+#include "BadDataException.h"
 #include "FileWriteException.h"
 
 
-template <typename T>
-void DXFExport::exportContourLinesToDXF(const std::string &file_name, TVector2D <std::shared_ptr <Point3D> > contours_polylines, const T font_height)
+inline unsigned int DXFExport::beginContourLines(DXFWriter & file, const TDXFEntityType entity_type)
 {
-	//Export contour lines given to DXF file
-	const unsigned int color_cont = 1, color_cont_points = 5;
-	const std::string level_cont = "contour_lines", level_cont_points = "contour_lines_points", level_points_labels = "dt_points_labels";
-
-	std::ofstream file;
+	//Create header, tables and start the entity section, contour lines follow
+	//Create header section
+	createHeaderSection(file, entity_type);
 
-	try
+	//Create tables, blocks and start the entity section of the R2000 file
+	if (entity_type == DXFLWPolylines)
 	{
-		file.open(file_name/*, ios::out*/);
+		createTablesR2000(file);
 
-		if (file.is_open())
-		{
-			//Create header section
-			createHeaderSection(file);
+		file.writeGroup(0, "SECTION");
+		file.writeGroup(2, "BLOCKS");
+		createBlock(file, "*Model_Space", ModelSpaceBlockHandle, ModelSpaceEndBlockHandle, ModelSpaceHandle, false);
+		createBlock(file, "*Paper_Space", PaperSpaceBlockHandle, PaperSpaceEndBlockHandle, PaperSpaceHandle, true);
+		file.writeGroup(0, "ENDSEC");
 
-			//Create table section
-			createTableSection(file);
+		createEntitySection(file);
 
-			//Create layer for contour lines
-			createLayerSection(file, level_cont, color_cont);
+		return FirstEntityHandle;
+	}
 
-			//Create layer for dt contour lines labels
-			createLayerSection(file, level_cont_points, color_cont_points);
+	//Create table section
+	createTableSection(file);
 
-			//End table header
-			endTableSection(file);
+	//Create layer for contour lines
+	createLayerSection(file, LAYER_CONTOURS, COLOR_CONTOURS);
 
-			//Create entity section
-			createEntitySection(file);
+	//Create layer for dt contour lines labels
+	createLayerSection(file, LAYER_CONTOURS_POINTS, COLOR_CONTOURS_POINTS);
 
-			//Process contour lines
-			for (TVector <std::shared_ptr<Point3D > > polyline : contours_polylines)
-			{
-				processPolyline(file, polyline, level_cont, color_cont);
-			}
+	//End table header
+	endTableSection(file);
 
-			//End header section
-			endHeaderSection(file);
+	//Create entity section
+	createEntitySection(file);
 
-			//Close file
-			file.close();
-		}
+	//AC1006 entities have no handles
+	return 0;
+}
 
-		//Throw exception
-		else
-		{
-			//Can not open file
-			throw std::ios_base::failure("Exception: can not open the file. ");
-		}
-	}
 
-	//Any error has appeared
-	catch (std::ios_base::failure &)
-	{
-		//Close file
-		file.close();
+inline void DXFExport::createContourLine(DXFWriter & file, const PolylineSpan& polyline, const TDXFEntityType entity_type, unsigned int & handle)
+{
+	//Create entities of the contour line in its layer
+	processPolyline(file, polyline, LAYER_CONTOURS, COLOR_CONTOURS, entity_type, handle);
+}
 
-		//Throw exception
-		throw FileWriteException("FileWriteException: can not write the file: ", file_name);
+
+inline void DXFExport::endContourLines(DXFWriter & file, const TDXFEntityType entity_type)
+{
+	//End entity section, the R2000 file ends by the OBJECTS section
+	if (entity_type == DXFLWPolylines)
+	{
+		file.writeGroup(0, "ENDSEC");
+		createObjectsSection(file);
+		file.writeGroup(0, "EOF");
 	}
+
+	//End header section
+	else
+		endHeaderSection(file);
+
+	//Close file
+	file.close();
 }
 
 
-inline void DXFExport::createHeaderSection ( std::ofstream & file )
+inline void DXFExport::createHeaderSection (DXFWriter & file, const TDXFEntityType entity_type)
 {
-        //Create header section
-	const std::string object_type_id = "0\n";
-	const std::string object_type = "SECTION\n";
-	const std::string header_id = "2\n";
-	const std::string header_name = "HEADER\n";
-	const std::string variable_name = "9\n";
-	const std::string acad_version = "$ACADVER\n";
-	const std::string acad_version_id =  "1\n";
-	const std::string acad_version_val = "AC1006\n";
-	const std::string section_terminator = "ENDSEC\n";
-        
-	/* Add to file */
-	file << object_type_id;
-        file << object_type;
-        file << header_id;
-        file << header_name;
-        file << variable_name;
-        file << acad_version;
-        file << acad_version_id;
-        file << acad_version_val;
-        file << object_type_id;
-        file << section_terminator;
+        //Create header section, AC1006 does not require handles, subclass markers and the OBJECTS section
+	file.writeGroup(0, "SECTION");
+	file.writeGroup(2, "HEADER");
+	file.writeGroup(9, "$ACADVER");
+
+	if (entity_type != DXFLWPolylines)
+	{
+		file.writeGroup(1, "AC1006");
+		file.writeGroup(0, "ENDSEC");
+
+		return;
+	}
+
+	//LWPOLYLINE requires AutoCAD R2000 (AC1015), the next free handle and the empty CLASSES section
+	file.writeGroup(1, "AC1015");
+	file.writeGroup(9, "$DWGCODEPAGE");
+	file.writeGroup(3, "ANSI_1252");
+	file.writeGroup(9, "$HANDSEED");
+	file.writeHandle(5, HANDLE_SEED);
+	file.writeGroup(0, "ENDSEC");
+
+	file.writeGroup(0, "SECTION");
+	file.writeGroup(2, "CLASSES");
+	file.writeGroup(0, "ENDSEC");
 }
 
 
-inline void DXFExport::endHeaderSection (std::ofstream & file)
+inline void DXFExport::endHeaderSection (DXFWriter & file)
 {
         //Create end of the header section
-	const std::string entity_id = "0\n";
-	const std::string section_terminator ="ENDSEC\n";
-	const std::string file_terminator = "EOF\n";
-	
-	/* Add to file */
-	file << entity_id;
-        file << section_terminator;
-        file << entity_id;
-        file << file_terminator;
+	file.writeGroup(0, "ENDSEC");
+	file.writeGroup(0, "EOF");
 }
 
 
-inline void DXFExport::createTableSection (std::ofstream & file )
+inline void DXFExport::createTableSection (DXFWriter & file )
 {
         //Create table section
-	const std::string object_type_id = "0\n";
-	const std::string object_name = "SECTION\n";
-	const std::string table_id = "2\n";
-	const std::string table = "TABLES\n";
-	const std::string table_name = "TABLE\n";
-	const std::string layer_name = "LAYER\n";
-	const std::string max_number_of_entries_id = "70\n";
-	const std::string max_number_of_entries = "0\n";
-
-        file << object_type_id;
-        file << object_name;
-        file << table_id;
-        file << table;
-        file << object_type_id;
-        file << table_name;
-	file << table_id;
-        file << layer_name;
-        file << max_number_of_entries_id;
-        file << max_number_of_entries;
+	file.writeGroup(0, "SECTION");
+	file.writeGroup(2, "TABLES");
+	file.writeGroup(0, "TABLE");
+	file.writeGroup(2, "LAYER");
+	file.writeGroup(70, 0);
 }
 
 
-inline void DXFExport::endTableSection ( std::ofstream & file )
+inline void DXFExport::endTableSection ( DXFWriter & file )
 {
         //Write end of the table section
-	const std::string object_type_id = "0\n";
-	const std::string table_end_name = "ENDTAB\n";
-	const std::string section_end_name = "ENDSEC\n";
-
-	/* Add to file */
-        file << object_type_id;
-        file << table_end_name;
-        file << object_type_id;
-        file << section_end_name;
+	file.writeGroup(0, "ENDTAB");
+	file.writeGroup(0, "ENDSEC");
 }
 
 
-inline void DXFExport::createLayerSection (std::ofstream & file, const std::string &layer_name, const unsigned int color )
+inline void DXFExport::createLayerSection (DXFWriter & file, const std::string &layer_name, const unsigned int color )
 {
         //Add section for one layer
-	const std::string object_type_id = "0\n";
-	const std::string object_name = "LAYER\n";
-	const std::string layer_name_id = "2\n";
-	const std::string layer_flag_id = "70\n";
-	const std::string layer_flag = "0\n";
-	const std::string color_number_id = "62\n";
-	const std::string line_type_id = "6\n";
-	const std::string line_type_name = "CONTINUOUS\n";
-
-	/* Add to file */
-        file << object_type_id;
-        file << object_name;
-        file << layer_name_id;
-	file << layer_name << '\n';
-        file << layer_flag_id;
-        file << layer_flag;
-        file << color_number_id;
-        file << color << '\n';
-        file << line_type_id;
-        file << line_type_name;
+	file.writeGroup(0, "LAYER");
+	file.writeGroup(2, layer_name);
+	file.writeGroup(70, 0);
+	file.writeGroup(62, (int)color);
+	file.writeGroup(6, "CONTINUOUS");
 }
 
 
-inline void DXFExport::createEntitySection ( std::ofstream & file )
+inline void DXFExport::createEntitySection ( DXFWriter & file )
 {
         //Create section for entities
-	const std::string object_type_id = "0\n";
-	const std::string object_name = "SECTION\n";
-	const std::string entity_name_id = "2\n";
-	const std::string entity_name = "ENTITIES\n";
-
-	/* Add to file */
-        file << object_type_id;
-        file << object_name;
-        file << entity_name_id;
-        file << entity_name;
+	file.writeGroup(0, "SECTION");
+	file.writeGroup(2, "ENTITIES");
+}
+
+
+inline void DXFExport::createTablesR2000(DXFWriter & file)
+{
+	//Create all symbol tables of the R2000 file with the records referenced by the entities and the default records required by AutoCAD
+	file.writeGroup(0, "SECTION");
+	file.writeGroup(2, "TABLES");
+
+	//Viewports are created by the reader
+	createTable(file, "VPORT", VPortTableHandle, 0);
+	file.writeGroup(0, "ENDTAB");
+
+	//Line types
+	createTable(file, "LTYPE", LTypeTableHandle, 3);
+
+	const std::pair <const char*, unsigned int> line_types[] = { { "ByBlock", ByBlockHandle }, { "ByLayer", ByLayerHandle }, { "Continuous", ContinuousHandle } };
+
+	for (const auto& [name, handle] : line_types)
+	{
+		createTableRecord(file, "LTYPE", "AcDbLinetypeTableRecord", handle, LTypeTableHandle, name);
+		file.writeGroup(3, handle == ContinuousHandle ? "Solid line" : "");
+		file.writeGroup(72, 65);
+		file.writeGroup(73, 0);
+		file.writeGroup(40, 0.0);
+	}
+
+	file.writeGroup(0, "ENDTAB");
+
+	//Layers
+	createTable(file, "LAYER", LayerTableHandle, 3);
+
+	const std::tuple <std::string, unsigned int, unsigned int> layers[] = { { "0", Layer0Handle, 7 }, { LAYER_CONTOURS, LayerContoursHandle, COLOR_CONTOURS },
+		{ LAYER_CONTOURS_POINTS, LayerContoursPointsHandle, COLOR_CONTOURS_POINTS } };
+
+	for (const auto& [name, handle, color] : layers)
+	{
+		createTableRecord(file, "LAYER", "AcDbLayerTableRecord", handle, LayerTableHandle, name);
+		file.writeGroup(62, (int)color);
+		file.writeGroup(6, "Continuous");
+	}
+
+	file.writeGroup(0, "ENDTAB");
+
+	//Text styles
+	createTable(file, "STYLE", StyleTableHandle, 1);
+	createTableRecord(file, "STYLE", "AcDbTextStyleTableRecord", StandardStyleHandle, StyleTableHandle, "Standard");
+	file.writeGroup(40, 0.0);
+	file.writeGroup(41, 1.0);
+	file.writeGroup(50, 0.0);
+	file.writeGroup(71, 0);
+	file.writeGroup(42, 2.5);
+	file.writeGroup(3, "txt");
+	file.writeGroup(4, "");
+	file.writeGroup(0, "ENDTAB");
+
+	//Views and user coordinate systems
+	createTable(file, "VIEW", ViewTableHandle, 0);
+	file.writeGroup(0, "ENDTAB");
+	createTable(file, "UCS", UCSTableHandle, 0);
+	file.writeGroup(0, "ENDTAB");
+
+	//Registered applications
+	createTable(file, "APPID", AppIdTableHandle, 1);
+	createTableRecord(file, "APPID", "AcDbRegAppTableRecord", AcadAppIdHandle, AppIdTableHandle, "ACAD");
+	file.writeGroup(0, "ENDTAB");
+
+	//Dimension styles, the table has its own subclass
+	createTable(file, "DIMSTYLE", DimStyleTableHandle, 1);
+	file.writeGroup(100, "AcDbDimStyleTable");
+	file.writeGroup(71, 1);
+	file.writeHandle(340, StandardDimStyleHandle);
+	createTableRecord(file, "DIMSTYLE", "AcDbDimStyleTableRecord", StandardDimStyleHandle, DimStyleTableHandle, "Standard");
+	file.writeGroup(0, "ENDTAB");
+
+	//Block records of the model and paper space
+	createTable(file, "BLOCK_RECORD", BlockRecordTableHandle, 2);
+	createTableRecord(file, "BLOCK_RECORD", "AcDbBlockTableRecord", ModelSpaceHandle, BlockRecordTableHandle, "*Model_Space");
+	createTableRecord(file, "BLOCK_RECORD", "AcDbBlockTableRecord", PaperSpaceHandle, BlockRecordTableHandle, "*Paper_Space");
+	file.writeGroup(0, "ENDTAB");
+
+	file.writeGroup(0, "ENDSEC");
+}
+
+
+inline void DXFExport::createTable(DXFWriter & file, const std::string &table_name, const unsigned int handle, const int count)
+{
+	//Start the R2000 symbol table owned by no object
+	file.writeGroup(0, "TABLE");
+	file.writeGroup(2, table_name);
+	file.writeHandle(5, handle);
+	file.writeHandle(330, 0);
+	file.writeGroup(100, "AcDbSymbolTable");
+	file.writeGroup(70, count);
+}
+
+
+inline void DXFExport::createTableRecord(DXFWriter & file, const std::string &record_type, const std::string &subclass, const unsigned int handle, const unsigned int table_handle, const std::string &name)
+{
+	//Write the common part of the R2000 symbol table record owned by its table, the dimension style has the handle code 105
+	file.writeGroup(0, record_type);
+	file.writeHandle(record_type == "DIMSTYLE" ? 105 : 5, handle);
+	file.writeHandle(330, table_handle);
+	file.writeGroup(100, "AcDbSymbolTableRecord");
+	file.writeGroup(100, subclass);
+	file.writeGroup(2, name);
+	file.writeGroup(70, 0);
+}
+
+
+inline void DXFExport::createBlock(DXFWriter & file, const std::string &block_name, const unsigned int handle, const unsigned int end_handle, const unsigned int owner_handle, const bool paper_space)
+{
+	//Write the empty R2000 block owned by its block record
+	file.writeGroup(0, "BLOCK");
+	file.writeHandle(5, handle);
+	file.writeHandle(330, owner_handle);
+	file.writeGroup(100, "AcDbEntity");
+
+	if (paper_space)
+		file.writeGroup(67, 1);
+
+	file.writeGroup(8, "0");
+	file.writeGroup(100, "AcDbBlockBegin");
+	file.writeGroup(2, block_name);
+	file.writeGroup(70, 0);
+	file.writeGroup(10, 0.0);
+	file.writeGroup(20, 0.0);
+	file.writeGroup(30, 0.0);
+	file.writeGroup(3, block_name);
+	file.writeGroup(1, "");
+
+	file.writeGroup(0, "ENDBLK");
+	file.writeHandle(5, end_handle);
+	file.writeHandle(330, owner_handle);
+	file.writeGroup(100, "AcDbEntity");
+
+	if (paper_space)
+		file.writeGroup(67, 1);
+
+	file.writeGroup(8, "0");
+	file.writeGroup(100, "AcDbBlockEnd");
+}
+
+
+inline void DXFExport::createObjectsSection(DXFWriter & file)
+{
+	//Create the OBJECTS section of the R2000 file: root dictionary owned by no object and its empty dictionary of groups
+	file.writeGroup(0, "SECTION");
+	file.writeGroup(2, "OBJECTS");
+
+	file.writeGroup(0, "DICTIONARY");
+	file.writeHandle(5, RootDictionaryHandle);
+	file.writeHandle(330, 0);
+	file.writeGroup(100, "AcDbDictionary");
+	file.writeGroup(3, "ACAD_GROUP");
+	file.writeHandle(350, GroupDictionaryHandle);
+
+	file.writeGroup(0, "DICTIONARY");
+	file.writeHandle(5, GroupDictionaryHandle);
+	file.writeHandle(330, RootDictionaryHandle);
+	file.writeGroup(100, "AcDbDictionary");
+
+	file.writeGroup(0, "ENDSEC");
 }
 
 
 template <typename T>
-void DXFExport::createLine (std::ofstream & file, const std::string &layer_name, const T x1, const T y1, const T z1, const T x2, const T y2, const T z2, const int color)
+void DXFExport::createLine (DXFWriter & file, const std::string &layer_name, const T x1, const T y1, const T z1, const T x2, const T y2, const T z2, const int color)
 {
         //Write line to DXF file
-	const std::string entity_id = "0\n";
-	const std::string entity_name = "LINE\n";
-	const std::string level_id = "8\n";
-	const std::string color_id = "62\n";
-	const std::string xi_id = "10\n";
-	const std::string yi_id = "20\n";
-	const std::string zi_id = "30\n";
-	const std::string xii_id = "11\n";
-	const std::string yii_id = "21\n";
-	const std::string zii_id = "31\n";
-
-	//Set format and precision
-	file << std::fixed << std::setprecision(3);
-
-        /* Add to file */
-        file << entity_id;
-        file << entity_name;
-        file << level_id;
-	file << layer_name << '\n';
-	file << color_id;
-	file << color << '\n';
-        file << xi_id;
-        file << x1 << '\n';
-	file << yi_id;
-	file << y1 << '\n';
-        file << zi_id;
-        file << z1 << '\n';
-        file << xii_id;
-        file << x2 << '\n';
-        file << yii_id;
-        file << y2 << '\n';
-        file << zii_id;
-        file << z2 << '\n';
+	file.writeGroup(0, "LINE");
+	file.writeGroup(8, layer_name);
+	file.writeGroup(62, color);
+	file.writeGroup(10, (double)x1);
+	file.writeGroup(20, (double)y1);
+	file.writeGroup(30, (double)z1);
+	file.writeGroup(11, (double)x2);
+	file.writeGroup(21, (double)y2);
+	file.writeGroup(31, (double)z2);
+}
+
+
+inline void DXFExport::createLWPolyline(DXFWriter & file, const PolylineSpan& polyline, const std::string &layer_name, const int color, const unsigned int handle)
+{
+	//Write polyline as one LWPOLYLINE entity of the model space, planar vertices at the elevation of the polyline
+	file.writeGroup(0, "LWPOLYLINE");
+	file.writeHandle(5, handle);
+	file.writeHandle(330, ModelSpaceHandle);
+	file.writeGroup(100, "AcDbEntity");
+	file.writeGroup(8, layer_name);
+	file.writeGroup(62, color);
+	file.writeGroup(100, "AcDbPolyline");
+	file.writeGroup(90, polyline.size());
+	file.writeGroup(70, 0);
+	file.writeGroup(38, polyline.getZ());
+
+	for (int i = 0; i < polyline.size(); i++)
+	{
+		file.writeGroup(10, polyline.getX(i));
+		file.writeGroup(20, polyline.getY(i));
+	}
 }
 
 
-void DXFExport::processPolyline(std::ofstream & file, TVector <std::shared_ptr<Point3D > > polyline, const std::string &layer_name, const unsigned int color)
+inline void DXFExport::createPolyline(DXFWriter & file, const PolylineSpan& polyline, const std::string &layer_name, const int color)
+{
+	//Write polyline as POLYLINE entity followed by VERTEX entities and SEQEND (AC1006 and later)
+	//The 2D polyline is placed at the elevation of the polyline
+	file.writeGroup(0, "POLYLINE");
+	file.writeGroup(8, layer_name);
+	file.writeGroup(62, color);
+	file.writeGroup(66, 1);
+	file.writeGroup(10, 0.0);
+	file.writeGroup(20, 0.0);
+	file.writeGroup(30, polyline.getZ());
+	file.writeGroup(70, 0);
+
+	for (int i = 0; i < polyline.size(); i++)
+	{
+		file.writeGroup(0, "VERTEX");
+		file.writeGroup(8, layer_name);
+		file.writeGroup(10, polyline.getX(i));
+		file.writeGroup(20, polyline.getY(i));
+	}
+
+	file.writeGroup(0, "SEQEND");
+	file.writeGroup(8, layer_name);
+}
+
+
+inline void DXFExport::processPolyline(DXFWriter & file, const PolylineSpan& polyline, const std::string &layer_name, const unsigned int color, const TDXFEntityType entity_type, unsigned int & handle)
 {
 	//Process polyline
 	const unsigned int n = polyline.size();
 
+	//Polyline needs at least one segment
+	if (n < 2)
+		return;
+
+	//One polyline entity with the next handle, the handles stay below $HANDSEED
+	if (entity_type == DXFLWPolylines)
+	{
+		//Throw exception
+		if (handle >= HANDLE_SEED)
+			throw BadDataException("BadDataException: too many DXF entities, ", "handle " + std::to_string(handle));
+
+		return createLWPolyline(file, polyline, layer_name, color, handle++);
+	}
+
+	//Polyline and vertex entities
+	if (entity_type == DXFPolylines)
+		return createPolyline(file, polyline, layer_name, color);
+
 	//Process halfedges one by one
-	for (unsigned int i = 0; i < n - 1; i++)
+	for (unsigned int i = 0; i + 1 < n; i++)
 	{
 		// Get start point
-		const double x1 = polyline[i]->getX();
-		const double y1 = polyline[i]->getY();
-		const double z1 = polyline[i]->getZ();
+		const double x1 = polyline.getX(i);
+		const double y1 = polyline.getY(i);
+		const double z1 = polyline.getZ();
 
 		// Get end point
-		const double x2 = polyline[i+1]->getX();
-		const double y2 = polyline[i+1]->getY();
-		const double z2 = polyline[i+1]->getZ();
+		const double x2 = polyline.getX(i + 1);
+		const double y2 = polyline.getY(i + 1);
+		const double z2 = polyline.getZ();
 
 		//Create line
 		createLine(file, layer_name, x1, y1, z1, x2, y2, z2, color);
 	}
 }
 
-
-template <typename T>
-std::string DXFExport::to_string(const T value, const unsigned short dec_places)
-{
-	//Convert to string,  set the decimal places
-	std::ostringstream out;
-	out << std::setprecision(dec_places) << value;
-	return out.str();
-}
-
 #endif
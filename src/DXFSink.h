@@ -0,0 +1,52 @@
+// Description: Streaming DXF export of the simplified contour lines
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef DXFSink_H
+#define DXFSink_H
+
+#include <string>
+
+#include "PolylineStore.h"
+#include "ContourLinesSink.h"
+#include "DXFExport.h"
+#include "DXFWriter.h"
+
+//DXF file receiving the contour lines one by one
+//Sections preceding the entities are written when the file is opened, the entities of each contour line
+//are appended to the buffer of DXFWriter, the file is ended by close().
+class DXFSink : public ContourLinesSink
+{
+        private:
+                DXFWriter file;
+                TDXFEntityType entity_type;             //Entities representing the contour lines
+                unsigned int handle;                    //Handle of the next entity (R2000 file)
+
+        public:
+                DXFSink(const std::string& file_name, const TDXFEntityType entity_type_ = DXFLines, const bool binary = false);
+
+        public:
+                void addPolyline(const PolylineSpan& polyline, const int source_id) override;
+                void close() override;
+};
+
+#include "DXFSink.hpp"
+
+#endif
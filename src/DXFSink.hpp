@@ -0,0 +1,46 @@
+// Description: Streaming DXF export of the simplified contour lines
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef DXFSink_HPP
+#define DXFSink_HPP
+
+
+inline DXFSink::DXFSink(const std::string& file_name, const TDXFEntityType entity_type_, const bool binary) : file(file_name, binary, DXFExport::getGroupCodeSize(entity_type_)), entity_type(entity_type_), handle(0)
+{
+	//Open file, throws exception, and create sections preceding the contour lines
+	handle = DXFExport::beginContourLines(file, entity_type);
+}
+
+
+inline void DXFSink::addPolyline(const PolylineSpan& polyline, const int /*source_id*/)
+{
+	//Create entities of the contour line, the source id is not stored
+	DXFExport::createContourLine(file, polyline, entity_type, handle);
+}
+
+
+inline void DXFSink::close()
+{
+	//End entity section and close file
+	DXFExport::endContourLines(file, entity_type);
+}
+
+#endif
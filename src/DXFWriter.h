@@ -0,0 +1,72 @@
+// Description: Buffered writer of DXF group codes and values
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef DXFWriter_H
+#define DXFWriter_H
+
+#include <string>
+#include <string_view>
+#include <fstream>
+
+#include "TVector.h"
+
+//Buffered writer of the DXF group code / value pairs
+//ASCII DXF: pairs are formatted by std::to_chars into the large user-space buffer written to the file when it is full,
+//the stream formatting state is not used. Real values are written in the fixed notation.
+//Binary DXF: group codes (1 byte up to AC1009, 2 bytes later) are followed by the typed values given by the code:
+//null terminated strings, 16 or 32 bit integers and IEEE doubles, all little-endian, without any precision loss.
+class DXFWriter
+{
+        private:
+                static const int BUFFER_SIZE = 1 << 20;         //Size of the buffer in bytes
+                static const int DECIMAL_PLACES = 3;            //Decimal places of real values
+                static const int MAX_ITEM_SIZE = 64;            //Maximum length of the formatted code or number
+
+                std::string file_name;
+                std::ofstream file;
+                TVector <char> buffer;
+                std::size_t used;                               //Amount of used bytes of the buffer
+                bool binary;                                    //Binary DXF
+                int code_size;                                  //Size of the binary group code in bytes
+
+        public:
+                DXFWriter(const std::string& file_name_, const bool binary_ = false, const int code_size_ = 1);
+                DXFWriter(const DXFWriter&) = delete;
+                DXFWriter& operator = (const DXFWriter&) = delete;
+
+        public:
+                void writeGroup(const int code, std::string_view value);
+                void writeGroup(const int code, const int value);
+                void writeGroup(const int code, const double value);
+                void writeHandle(const int code, const unsigned int handle);
+                void close();
+
+        private:
+                void writeCode(const int code);
+                template <typename T>
+                void writeBinary(const T value);
+                void append(std::string_view text);
+                void flush();
+};
+
+#include "DXFWriter.hpp"
+
+#endif
@@ -0,0 +1,207 @@
+// Description: Buffered writer of DXF group codes and values
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef DXFWriter_HPP
+#define DXFWriter_HPP
+
+#include <charconv>
+#include <cctype>
+#include <cstring>
+#include <cstdint>
+#include <bit>
+#include <algorithm>
+
+#include "FileWriteException.h"
+
+
+inline DXFWriter::DXFWriter(const std::string& file_name_, const bool binary_, const int code_size_) : file_name(file_name_), buffer(BUFFER_SIZE), used(0), binary(binary_), code_size(code_size_)
+{
+	//Open the output file
+	file.open(file_name, binary ? std::ios::out | std::ios::binary : std::ios::out);
+
+	//Throw exception
+	if (!file.is_open())
+		throw FileWriteException("FileWriteException: can not write the file: ", file_name);
+
+	//Sentinel of the binary DXF
+	if (binary)
+		append(std::string_view("AutoCAD Binary DXF\r\n\x1a\0", 22));
+}
+
+
+inline void DXFWriter::writeGroup(const int code, std::string_view value)
+{
+	//Write group code and the string value
+	writeCode(code);
+	append(value);
+	append(binary ? std::string_view("", 1) : std::string_view("\n"));
+}
+
+
+inline void DXFWriter::writeGroup(const int code, const int value)
+{
+	//Write group code and the integer value
+	writeCode(code);
+
+	//Binary DXF: 32-bit integer codes 90-99, 420-459, 1071, other integer codes are 16-bit
+	if (binary)
+	{
+		if ((code >= 90 && code <= 99) || (code >= 420 && code <= 459) || (code == 1071))
+			writeBinary((int32_t)value);
+		else
+			writeBinary((int16_t)value);
+
+		return;
+	}
+
+	if (used + MAX_ITEM_SIZE > buffer.size())
+		flush();
+
+	char* last = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value).ptr;
+	*last++ = '\n';
+	used = last - buffer.data();
+}
+
+
+inline void DXFWriter::writeGroup(const int code, const double value)
+{
+	//Write group code and the real value in the fixed notation, binary DXF stores the double
+	writeCode(code);
+
+	if (binary)
+	{
+		writeBinary(value);
+		return;
+	}
+
+	if (used + MAX_ITEM_SIZE > buffer.size())
+		flush();
+
+	const std::to_chars_result result = std::to_chars(buffer.data() + used, buffer.data() + buffer.size() - 1, value, std::chars_format::fixed, DECIMAL_PLACES);
+
+	//Throw exception
+	if (result.ec != std::errc())
+		throw FileWriteException("FileWriteException: can not format the value in the file: ", file_name);
+
+	char* last = result.ptr;
+	*last++ = '\n';
+	used = last - buffer.data();
+}
+
+
+inline void DXFWriter::writeHandle(const int code, const unsigned int handle)
+{
+	//Write the handle or the reference to the handle as the upper case hexadecimal string
+	char text[16];
+	char* last = std::to_chars(text, text + sizeof(text), handle, 16).ptr;
+	std::transform(text, last, text, [](const char c) { return (char)toupper(c); });
+
+	writeGroup(code, std::string_view(text, last - text));
+}
+
+
+inline void DXFWriter::close()
+{
+	//Write the rest of the buffer and close the file
+	flush();
+	file.close();
+
+	//Throw exception
+	if (file.fail())
+		throw FileWriteException("FileWriteException: can not write the file: ", file_name);
+}
+
+
+inline void DXFWriter::writeCode(const int code)
+{
+	//Binary group code, 255 precedes the 16-bit code in the files with 1 byte codes
+	if (binary)
+	{
+		if (code_size == 2)
+			writeBinary((int16_t)code);
+
+		else if (code < 255)
+			writeBinary((uint8_t)code);
+
+		else
+		{
+			writeBinary((uint8_t)255);
+			writeBinary((int16_t)code);
+		}
+
+		return;
+	}
+
+	//Write group code on the separate line
+	if (used + MAX_ITEM_SIZE > buffer.size())
+		flush();
+
+	char* last = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), code).ptr;
+	*last++ = '\n';
+	used = last - buffer.data();
+}
+
+
+template <typename T>
+void DXFWriter::writeBinary(const T value)
+{
+	//Write the value in the little-endian byte order
+	if (used + sizeof(T) > buffer.size())
+		flush();
+
+	memcpy(buffer.data() + used, &value, sizeof(T));
+
+	if constexpr (std::endian::native == std::endian::big)
+		std::reverse(buffer.begin() + used, buffer.begin() + used + sizeof(T));
+
+	used += sizeof(T);
+}
+
+
+inline void DXFWriter::append(std::string_view text)
+{
+	//Append text to the buffer, long text is written directly
+	if (used + text.size() > buffer.size())
+		flush();
+
+	if (text.size() > buffer.size())
+		file.write(text.data(), text.size());
+
+	else
+	{
+		memcpy(buffer.data() + used, text.data(), text.size());
+		used += text.size();
+	}
+}
+
+
+inline void DXFWriter::flush()
+{
+	//Write the buffer to the file
+	file.write(buffer.data(), used);
+	used = 0;
+
+	//Throw exception
+	if (file.fail())
+		throw FileWriteException("FileWriteException: can not write the file: ", file_name);
+}
+
+#endif
@@ -21,117 +21,345 @@
 
 #include "File.h"
 
-#include <fstream>
 #include <iostream>
 #include <filesystem>
 #include <stdio.h>
 #include <ctype.h>
+#include <string.h>
+#include <charconv>
+#include <string_view>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <memory>
 
-#include "WildcardStringMatching.h"
-#include "isEqualPointByPlanarCoordinates.h"
+#include "Const.h"
+#include "MappedFile.h"
+#include "UringFileReader.h"
+#include "ShapefileReader.h"
+#include "WildcardPattern.h"
 #include "Exception.h"
 #include "FileReadException.h"
-#include "Round.h"
 
 
-void File::findFilesInDirByMask(const std::string& path, const std::string &mask, const bool full_path, TVector <std::string>& files)
+void File::findFilesInDirByMasks(const std::string& path, const TVector <std::string>& masks, const bool full_path, const bool recursive, TVector2D <std::string>& files)
 {
-        //Find all files containining "mask" in specified dir
-        //Wildcards * ? are supported
-        for (auto& p : std::filesystem::directory_iterator(path))
+        //Classify files of the dir by several masks in one scan, files[i] are the files matching masks[i]
+        //Masks with wildcards * ? are compiled once and matched to the file names, subdirs are scanned if recursive
+        TVector <WildcardPattern> patterns(masks.begin(), masks.end());
+        files.assign(masks.size(), TVector <std::string>());
+
+        auto classify = [&](const std::filesystem::directory_entry& entry)
         {
+                //Skip dirs and other special files
+                if (!entry.is_regular_file())
+                        return;
+
+                const std::string file_name = entry.path().filename().string();
 
-                if (WildcardStringMatching::matchStringToPattern(p.path().string(), mask))
+                for (std::size_t i = 0; i < patterns.size(); i++)
                 {
-                        //Store full path to the file
-                        if (full_path)
-                                files.push_back(p.path().string());
+                        if (patterns[i].match(file_name))
+                        {
+                                //Store full path to the file
+                                if (full_path)
+                                        files[i].push_back(entry.path().string());
 
-                        //Store only the file name
-                        else
-                                files.push_back(p.path().stem().string() + p.path().extension().string());
+                                //Store only the file name
+                                else
+                                        files[i].push_back(file_name);
+                        }
                 }
+        };
+
+        if (recursive)
+        {
+                for (const auto& entry : std::filesystem::recursive_directory_iterator(path))
+                        classify(entry);
+        }
+
+        else
+        {
+                for (const auto& entry : std::filesystem::directory_iterator(path))
+                        classify(entry);
         }
 }
 
 
-void File::loadPoints(const std::string& file_name, TVector <std::shared_ptr<Point3D > >& nl)
+void File::loadPoints(const std::string& file_name, const bool multiple, PolylineStore& polylines)
 {
-	//Load points from file
-	std::string line;
-	std::ifstream file;
+	//Load points from file as new polylines, the mapped file is parsed directly
+	const MappedFile file(file_name);
+	parsePoints(file.getContent(), file_name, multiple, polylines);
+}
 
-	try
+
+void File::parsePoints(std::string_view content, const std::string& file_name, const bool multiple, PolylineStore& polylines)
+{
+	//Parse points of the file content as new polylines, the height of the polyline is given by its first point
+	//Single polyline: rows "x y z", empty lines are skipped
+	//Multiple polylines: rows "x y z" separated by empty lines, or rows "id x y z", the polyline ends when id changes
+	//All rows must have the same amount of columns as the first one
+	//Duplicate points of each polyline are removed
+	int columns = multiple ? 0 : 3;
+	bool new_polyline = multiple;
+	double id = 0;
+
+	//Single polyline is created even for the empty file
+	if (!multiple)
+		polylines.addPolyline(0.0);
+
+	//Process line by line
+	const char* p = content.data();
+	const char* const end = p + content.size();
+	const char* line_end = p;
+	int rows = 0;
+
+	for (int line = 1; p < end; line++, p = line_end + 1)
 	{
-		file.open(file_name);
+		//Find end of the line
+		line_end = (const char*)memchr(p, '\n', end - p);
+
+		if (line_end == NULL)
+			line_end = end;
 
-		//Read line by line
-		while (std::getline(file, line))
+		//Parse id and coordinates of the point, one more value detects the extra column
+		double values[5];
+		const int n = parseRow(p, line_end, values, multiple ? 5 : 4);
+
+		//Empty line, separates polylines without the id column
+		if (n == 0)
 		{
-			char* cline = &line[0u];
-			char* item = strtok(cline, " \t");
+			new_polyline = new_polyline || (columns == 3 && multiple);
+			continue;
+		}
 
-			//Delimit the row
-			std::vector<std::string> row;
-			while (item != NULL)
-			{
-				row.push_back(item);
-				item = strtok(NULL, " \t");
-			}
+		//Amount of columns is given by the first row
+		if (columns == 0)
+			columns = (n >= 4 ? 4 : 3);
+
+		//Throw exception, missing or extra column
+		if (n != columns)
+			throw FileReadException(columns == 4 ? "FileReadException: invalid row, expected id x y z, " : "FileReadException: invalid row, expected x y z, ",
+				file_name + ", line " + std::to_string(line));
+
+		const double* coords = values + columns - 3;
+
+		//Id of the polyline has changed
+		if ((columns == 4) && (values[0] != id))
+			new_polyline = true;
+
+		id = values[0];
 
-			//Add point to the list
-			nl.push_back(std::make_shared <Point3D>(std::stod(row[0]), std::stod(row[1]), std::stod(row[2])));
+		//Start a new polyline
+		if (new_polyline)
+		{
+			//Remove possible duplicate points of the previous polyline
+			if (rows > 0)
+				polylines.removeDuplicateVertices(MIN_POINT_DIST2);
+
+			polylines.addPolyline(coords[2]);
+			new_polyline = false;
 		}
-	}
 
-	//Throw exception
-	catch (Exception & e)
-	{
-		throw FileReadException("FileReadException: can not open file. ", file_name);
+		//Set height of the single polyline
+		else if (rows == 0)
+			polylines.setZ(polylines.size() - 1, coords[2]);
+
+		polylines.addVertex(coords[0], coords[1]);
+		rows++;
 	}
+
+	//Remove possible duplicate points of the last polyline
+	if (rows > 0)
+		polylines.removeDuplicateVertices(MIN_POINT_DIST2);
 }
 
 
-void File::loadContours(const TVector <std::string>& cont_files, TVector2D <std::shared_ptr <Point3D> >& contours_polylines)
+bool File::isShapefile(const std::string& file_name)
 {
-	//Load contour lines
-	for (std::string f : cont_files)
+	//File has the .shp extension (case insensitive)
+	std::string extension = std::filesystem::path(file_name).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](const unsigned char c) { return (char)tolower(c); });
+
+	return extension == ".shp";
+}
+
+
+int File::parseRow(const char* first, const char* last, double* values, const int max_values)
+{
+	//Parse at most max_values numbers delimited by spaces or tabs, remaining items are ignored
+	//Returns the amount of parsed values, -1 if the item is not a number
+	int n = 0;
+
+	while (n < max_values)
 	{
-		//Load contour
-		TVector < std::shared_ptr <Point3D> > contour_polyline, contour_polyline_t;
-		loadPoints(f, contour_polyline);
+		//Skip delimiters
+		while ((first < last) && ((*first == ' ') || (*first == '\t') || (*first == '\r')))
+			first++;
 
-		//Remove possible duplicate points
-		contour_polyline.erase(std::unique(contour_polyline.begin(), contour_polyline.end(), isEqualPointByPlanarCoordinates<std::shared_ptr <Point3D > >()), contour_polyline.end());
+		//End of the row
+		if (first == last)
+			break;
 
-		//Add contour to the list
-		contours_polylines.push_back(contour_polyline);
+		//Explicit plus sign is not accepted by from_chars
+		if ((*first == '+') && (last - first > 1))
+			first++;
+
+		const auto [ptr, ec] = std::from_chars(first, last, values[n]);
+
+		//Item is not a number or it is followed by other characters
+		if ((ec != std::errc()) || ((ptr != last) && (*ptr != ' ') && (*ptr != '\t') && (*ptr != '\r')))
+			return -1;
+
+		first = ptr;
+		n++;
 	}
+
+	return n;
 }
 
 
-void File::loadBuffers(const TVector <std::string>& buf_files, std::multimap <double, TVector < std::shared_ptr < Point3D > > >& contour_buffers)
+void File::loadContours(const TVector <std::string>& cont_files, PolylineStore& contours_polylines, const int threads, const bool uring, const bool multiple, const std::string& height_attribute)
 {
-	//Load contour line buffer
-	for (std::string f : buf_files)
+	//Load contour lines, possible duplicate points are removed
+	loadFiles(cont_files, contours_polylines, threads, uring, multiple, height_attribute);
+}
+
+
+void File::loadBuffers(const TVector <std::string>& buf_files, PolylineStore& contour_buffers, const int threads, const bool uring, const bool multiple, const std::string& height_attribute)
+{
+	//Load contour line buffers, possible duplicate points are removed
+	loadFiles(buf_files, contour_buffers, threads, uring, multiple, height_attribute);
+}
+
+
+void File::loadFiles(const TVector <std::string>& files, PolylineStore& polylines, const int threads, const bool uring, const bool multiple, const std::string& height_attribute)
+{
+	//Load polylines from files, the file holds one or multiple polylines
+	//Polylines are merged in the order of the list, the result does not depend on the reader and the amount of threads
+	const int n = files.size();
+	TVector <PolylineStore> loaded;					//Polylines loaded by the reader
+	TVector <TLoadedFile> loaded_files(n);				//Reader store and its polylines loaded from the file
+	TVector <std::exception_ptr> errors(n);				//Exception thrown while loading the file
+
+	//Read files in batches by io_uring, fall back to the worker threads when it is not available or fails
+	//Shapefiles are always read by the worker threads
+	if (!uring || std::any_of(files.begin(), files.end(), isShapefile) || !readFilesBatched(files, multiple, loaded, loaded_files, errors))
+		readFilesParallel(files, threads, multiple, height_attribute, loaded, loaded_files, errors);
+
+	//Throw exception of the first failed file, all previous files have been loaded
+	for (int i = 0; i < n; i++)
 	{
-		//Load buffer vertices
-		TVector < std::shared_ptr <Point3D > > contour_buffer;
-		loadPoints(f, contour_buffer);
+		if (errors[i])
+			std::rethrow_exception(errors[i]);
+	}
+
+	//Merge loaded polylines in the order of files
+	int vertices = polylines.getVerticesCount();
+	for (const PolylineStore& l : loaded)
+		vertices += l.getVerticesCount();
+
+	int count = polylines.size();
+	for (const TLoadedFile& f : loaded_files)
+		count += f.count;
+
+	polylines.reserve(count, vertices);
+
+	for (const TLoadedFile& f : loaded_files)
+		for (int j = f.first; j < f.first + f.count; j++)
+			polylines.addPolyline(loaded[f.store][j]);
+}
+
+
+void File::readFilesParallel(const TVector <std::string>& files, const int threads, const bool multiple, const std::string& height_attribute, TVector <PolylineStore>& loaded, TVector <TLoadedFile>& loaded_files, TVector <std::exception_ptr>& errors)
+{
+	//Load polylines from files in parallel, the amount of threads 0 means all hardware threads
+	//Each file is loaded by one worker into its own store, workers take files in the order of the list
+	const int n = files.size();
+	const int nt = std::max(1, std::min(threads > 0 ? threads : (int)std::thread::hardware_concurrency(), n));
 
-		//Remove possible duplicate points
-		contour_buffer.erase(std::unique(contour_buffer.begin(), contour_buffer.end(), isEqualPointByPlanarCoordinates<std::shared_ptr <Point3D > >()), contour_buffer.end());
+	loaded.assign(nt, PolylineStore());
+	std::atomic <int> next_file(0);
+	std::atomic <bool> failed(false);
 
-		//Remove short buffers
-		//if (contour_buffer.size() > 20)
+	auto load = [&](const int t)
+	{
+		//Take next file until all files are loaded or loading of any file failed
+		for (int i = next_file++; (i < n) && !failed; i = next_file++)
 		{
-			//Get z coordinate
-			const double z = contour_buffer[0]->getZ();
-			const double zr = Round::roundNumber(z, 2);
+			try
+			{
+				//Load polylines of the shapefile or the text file
+				const int first = loaded[t].size();
+
+				if (isShapefile(files[i]))
+					ShapefileReader::loadPolylines(files[i], height_attribute, loaded[t]);
+				else
+					loadPoints(files[i], multiple, loaded[t]);
 
-			//Create buffer
-			contour_buffers.insert(std::pair < double, TVector < std::shared_ptr < Point3D > >> (zr, contour_buffer));
+				loaded_files[i] = { t, first, loaded[t].size() - first };
+			}
+
+			catch (...)
+			{
+				errors[i] = std::current_exception();
+				failed = true;
+			}
 		}
-	}
+	};
+
+	//Run workers, the calling thread is the first one
+	TVector <std::thread> workers;
+	for (int t = 1; t < nt; t++)
+		workers.emplace_back(load, t);
+
+	load(0);
+
+	for (std::thread& w : workers)
+		w.join();
 }
 
+
+bool File::readFilesBatched(const TVector <std::string>& files, const bool multiple, TVector <PolylineStore>& loaded, TVector <TLoadedFile>& loaded_files, TVector <std::exception_ptr>& errors)
+{
+	//Load polylines from files read in batches by io_uring, completed files are parsed by the calling thread
+	//Returns false when io_uring is not available or fails while reading, the files are read again by the caller
+	std::unique_ptr <UringFileReader> reader;
+
+	try
+	{
+		reader = std::make_unique <UringFileReader>();
+	}
+
+	catch (Exception&)
+	{
+		return false;
+	}
+
+	loaded.assign(1, PolylineStore());
+
+	try
+	{
+		reader->readFiles(files, [&](const int i, std::string_view content)
+			{
+				//Parse polylines
+				const int first = loaded[0].size();
+				parsePoints(content, files[i], multiple, loaded[0]);
+
+				loaded_files[i] = { 0, first, loaded[0].size() - first };
+			}, errors);
+	}
+
+	//io_uring failed while reading (errors of the files are stored, not thrown), discard loaded files
+	catch (Exception&)
+	{
+		loaded.clear();
+		loaded_files.assign(files.size(), TLoadedFile());
+		errors.assign(files.size(), std::exception_ptr());
+
+		return false;
+	}
+
+	return true;
+}
@@ -23,21 +23,37 @@
 #define File_H
 
 #include <string>
-#include <memory>
-#include <map>
+#include <string_view>
+#include <exception>
 
 #include "TVector.h"
 #include "TVector2D.h"
-#include "Point3D.h"
+#include "PolylineStore.h"
 
 //Input file operations, load text files
 class File
 {
+        private:
+		//Polylines loaded from the file: store of the reader and the range of polylines in the store
+		struct TLoadedFile
+		{
+			int store;
+			int first, count;
+		};
+
         public:
-		static void findFilesInDirByMask(const std::string& path, const std::string &mask, const bool full_path, TVector <std::string>& files);
-		static void loadPoints(const std::string& file_name, TVector <std::shared_ptr<Point3D > >& nl);
-		static void loadContours(const TVector <std::string>& cont_files, TVector2D <std::shared_ptr <Point3D> >& contours_polylines);
-		static void loadBuffers(const TVector <std::string>& buf_files, std::multimap <double, TVector < std::shared_ptr < Point3D > > >& contour_buffers);
+		static void findFilesInDirByMasks(const std::string& path, const TVector <std::string>& masks, const bool full_path, const bool recursive, TVector2D <std::string>& files);
+		static void loadPoints(const std::string& file_name, const bool multiple, PolylineStore& polylines);
+		static void loadContours(const TVector <std::string>& cont_files, PolylineStore& contours_polylines, const int threads, const bool uring, const bool multiple, const std::string& height_attribute);
+		static void loadBuffers(const TVector <std::string>& buf_files, PolylineStore& contour_buffers, const int threads, const bool uring, const bool multiple, const std::string& height_attribute);
+
+        private:
+		static void loadFiles(const TVector <std::string>& files, PolylineStore& polylines, const int threads, const bool uring, const bool multiple, const std::string& height_attribute);
+		static void readFilesParallel(const TVector <std::string>& files, const int threads, const bool multiple, const std::string& height_attribute, TVector <PolylineStore>& loaded, TVector <TLoadedFile>& loaded_files, TVector <std::exception_ptr>& errors);
+		static bool readFilesBatched(const TVector <std::string>& files, const bool multiple, TVector <PolylineStore>& loaded, TVector <TLoadedFile>& loaded_files, TVector <std::exception_ptr>& errors);
+		static void parsePoints(std::string_view content, const std::string& file_name, const bool multiple, PolylineStore& polylines);
+		static bool isShapefile(const std::string& file_name);
+		static int parseRow(const char* first, const char* last, double* values, const int max_values);
 
 };
 
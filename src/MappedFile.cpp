@@ -0,0 +1,140 @@
+// Description: Read-only memory mapping of the input file
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "FileReadException.h"
+
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& file_name) : data(nullptr), size(0), file_handle(INVALID_HANDLE_VALUE), mapping_handle(NULL)
+{
+	//Map the whole file for reading
+	file_handle = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+	//Throw exception
+	if (file_handle == INVALID_HANDLE_VALUE)
+		throw FileReadException("FileReadException: can not open file. ", file_name);
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file_handle, &file_size))
+	{
+		CloseHandle(file_handle);
+		throw FileReadException("FileReadException: can not get size of file. ", file_name);
+	}
+
+	size = (size_t)file_size.QuadPart;
+
+	//Empty file can not be mapped
+	if (size == 0)
+		return;
+
+	mapping_handle = CreateFileMappingA(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	if (mapping_handle != NULL)
+		data = (const char*)MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+
+	//Throw exception
+	if (data == nullptr)
+	{
+		if (mapping_handle != NULL)
+			CloseHandle(mapping_handle);
+
+		CloseHandle(file_handle);
+		throw FileReadException("FileReadException: can not map file. ", file_name);
+	}
+}
+
+
+MappedFile::~MappedFile()
+{
+	//Unmap the file and close handles
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+
+	if (mapping_handle != NULL)
+		CloseHandle(mapping_handle);
+
+	if (file_handle != INVALID_HANDLE_VALUE)
+		CloseHandle(file_handle);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& file_name) : data(nullptr), size(0)
+{
+	//Map the whole file for reading
+	const int fd = open(file_name.c_str(), O_RDONLY);
+
+	//Throw exception
+	if (fd < 0)
+		throw FileReadException("FileReadException: can not open file. ", file_name);
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0)
+	{
+		close(fd);
+		throw FileReadException("FileReadException: can not get size of file. ", file_name);
+	}
+
+	size = (size_t)file_stat.st_size;
+
+	//Empty file can not be mapped
+	if (size == 0)
+	{
+		close(fd);
+		return;
+	}
+
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	//Mapping remains valid after the descriptor is closed
+	close(fd);
+
+	//Throw exception
+	if (mapping == MAP_FAILED)
+		throw FileReadException("FileReadException: can not map file. ", file_name);
+
+	//File is read sequentially
+	madvise(mapping, size, MADV_SEQUENTIAL);
+
+	data = (const char*)mapping;
+}
+
+
+MappedFile::~MappedFile()
+{
+	//Unmap the file
+	if (data != nullptr)
+		munmap((void*)data, size);
+}
+
+#endif
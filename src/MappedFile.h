@@ -0,0 +1,51 @@
+// Description: Read-only memory mapping of the input file
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef MappedFile_H
+#define MappedFile_H
+
+#include <string>
+#include <string_view>
+
+//Read-only memory mapping of the whole file, the content is accessed as a character view without copying
+//POSIX mmap is used, Windows uses the file mapping object
+class MappedFile
+{
+        private:
+                const char* data;                       //First character of the mapped file
+                size_t size;                            //Size of the file in bytes
+
+#ifdef _WIN32
+                void* file_handle;                      //Handle of the opened file
+                void* mapping_handle;                   //Handle of the file mapping object
+#endif
+
+        public:
+                MappedFile(const std::string& file_name);
+                MappedFile(const MappedFile&) = delete;
+                MappedFile& operator = (const MappedFile&) = delete;
+                ~MappedFile();
+
+        public:
+                std::string_view getContent() const { return std::string_view(data, size); }
+};
+
+#endif
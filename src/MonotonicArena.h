@@ -0,0 +1,81 @@
+// Description: Monotonic arena of the short-lived temporaries
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef MonotonicArena_H
+#define MonotonicArena_H
+
+#include <cstddef>
+#include <memory_resource>
+
+#include "TVector.h"
+
+//Monotonic arena of the short-lived temporaries, one arena per worker
+//Memory is taken from the current block by advancing the offset, deallocation does nothing,
+//all memory is released at once by reset() after the unit of work (e.g. one part of the contour line).
+//When the unit needed more than one block, reset() merges the blocks into one block of the total size:
+//the following units of a similar size are served without any heap allocation.
+//Blocks are aligned to 64 bytes, so the arena may back Eigen::Map views used by the vectorized kernels.
+class MonotonicArena : public std::pmr::memory_resource
+{
+        private:
+                static constexpr std::size_t BLOCK_ALIGNMENT = 64;              //Alignment of the blocks
+                static constexpr std::size_t MIN_BLOCK_SIZE = 64 * 1024;        //Size of the first block
+
+                //Memory block taken from the heap
+                struct TBlock
+                {
+                        std::byte* data;
+                        std::size_t size;
+                };
+
+                TVector <TBlock> blocks;                //Blocks, the last one is the current block
+                std::size_t offset;                     //First free byte of the current block
+                std::size_t allocations;                //Amount of served allocations
+                std::size_t heap_allocations;           //Amount of blocks taken from the heap
+                std::size_t resets;                     //Amount of resets (processed units)
+
+        public:
+                MonotonicArena() : offset(0), allocations(0), heap_allocations(0), resets(0) {}
+                ~MonotonicArena() { release(); }
+
+                MonotonicArena(const MonotonicArena&) = delete;
+                MonotonicArena& operator = (const MonotonicArena&) = delete;
+
+        public:
+                void reset();
+
+                std::size_t getAllocations() const { return allocations; }
+                std::size_t getHeapAllocations() const { return heap_allocations; }
+                std::size_t getResets() const { return resets; }
+
+        private:
+                void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+                void do_deallocate(void* /*p*/, std::size_t /*bytes*/, std::size_t /*alignment*/) override {}
+                bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+                void addBlock(const std::size_t size);
+                void release();
+};
+
+#include "MonotonicArena.hpp"
+
+#endif
@@ -0,0 +1,90 @@
+// Description: Monotonic arena of the short-lived temporaries
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef MonotonicArena_HPP
+#define MonotonicArena_HPP
+
+#include <new>
+#include <algorithm>
+
+
+inline void MonotonicArena::reset()
+{
+	//Release all allocations at once
+	resets++;
+
+	//Merge the blocks to one block of the total size
+	if (blocks.size() > 1)
+	{
+		std::size_t size = 0;
+		for (const TBlock& block : blocks)
+			size += block.size;
+
+		release();
+		addBlock(size);
+	}
+
+	offset = 0;
+}
+
+
+inline void* MonotonicArena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+	//Allocate memory from the current block, take a new block if it does not fit
+	allocations++;
+
+	std::size_t first = blocks.empty() ? 0 : (offset + alignment - 1) / alignment * alignment;
+
+	if (blocks.empty() || (first + bytes > blocks.back().size))
+	{
+		addBlock(std::max({ MIN_BLOCK_SIZE, blocks.empty() ? 0 : 2 * blocks.back().size, bytes + alignment }));
+		first = 0;
+	}
+
+	offset = first + bytes;
+
+	return blocks.back().data + first;
+}
+
+
+inline void MonotonicArena::addBlock(const std::size_t size)
+{
+	//Take a new block from the heap
+	const std::size_t size_aligned = (size + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+
+	blocks.push_back({ static_cast<std::byte*>(::operator new(size_aligned, std::align_val_t(BLOCK_ALIGNMENT))), size_aligned });
+	heap_allocations++;
+	offset = 0;
+}
+
+
+inline void MonotonicArena::release()
+{
+	//Return all blocks to the heap
+	for (const TBlock& block : blocks)
+		::operator delete(block.data, std::align_val_t(BLOCK_ALIGNMENT));
+
+	blocks.clear();
+	offset = 0;
+}
+
+#endif
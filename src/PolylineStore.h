@@ -0,0 +1,89 @@
+// Description: Polylines stored as a structure of arrays, read-only views of polylines
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef PolylineStore_H
+#define PolylineStore_H
+
+#include <span>
+
+#include "TVector.h"
+
+//Read-only view of one polyline: planar coordinates of the vertices and the height of the polyline
+//The view does not own the data, it remains valid while the store is not modified
+class PolylineSpan
+{
+        private:
+                std::span <const double> x, y;          //Coordinates of the vertices
+                double z;                               //Height of the polyline
+
+        public:
+                PolylineSpan() : z(0) {}
+                PolylineSpan(std::span <const double> x_, std::span <const double> y_, const double z_) : x(x_), y(y_), z(z_) {}
+
+        public:
+                int size() const { return x.size(); }
+                bool empty() const { return x.empty(); }
+
+                double getX(const int i) const { return x[i]; }
+                double getY(const int i) const { return y[i]; }
+                double getZ() const { return z; }
+
+                const double* getXData() const { return x.data(); }
+                const double* getYData() const { return y.data(); }
+
+                PolylineSpan subspan(const int first, const int count) const { return PolylineSpan(x.subspan(first, count), y.subspan(first, count), z); }
+};
+
+
+//Polylines stored as a structure of arrays: contiguous x and y coordinates of all vertices,
+//one height per polyline and the offset table of the first vertices
+//Replaces the list of shared points, no vertex is allocated separately
+class PolylineStore
+{
+        private:
+                TVector <double> x, y;                  //Coordinates of the vertices of all polylines
+                TVector <double> z;                     //Height of the polyline
+                TVector <int> offsets;                  //First vertex of the polyline, polylines + 1 items
+
+        public:
+                PolylineStore() : offsets(1, 0) {}
+
+        public:
+                void reserve(const int polylines, const int vertices);
+                void addPolyline(const double z_);
+                void addPolyline(const double z_, const int count);
+                void addPolyline(const PolylineSpan& polyline);
+                void addVertex(const double x_, const double y_);
+                void setZ(const int i, const double z_) { z[i] = z_; }
+                void removeDuplicateVertices(const double min_dist2);
+                void clear();
+
+                int size() const { return z.size(); }
+                int getVerticesCount() const { return x.size(); }
+                PolylineSpan operator [] (const int i) const;
+                double* getXData(const int i) { return x.data() + offsets[i]; }
+                double* getYData(const int i) { return y.data() + offsets[i]; }
+};
+
+#include "PolylineStore.hpp"
+
+#endif
@@ -0,0 +1,119 @@
+// Description: Polylines stored as a structure of arrays, read-only views of polylines
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#ifndef PolylineStore_HPP
+#define PolylineStore_HPP
+
+
+inline void PolylineStore::reserve(const int polylines, const int vertices)
+{
+	//Reserve space for polylines and their vertices
+	x.reserve(vertices);
+	y.reserve(vertices);
+	z.reserve(polylines);
+	offsets.reserve(polylines + 1);
+}
+
+
+inline void PolylineStore::clear()
+{
+	//Remove all polylines, the allocated memory is kept for reuse
+	x.clear();
+	y.clear();
+	z.clear();
+	offsets.resize(1);
+}
+
+
+inline void PolylineStore::addPolyline(const double z_)
+{
+	//Start a new empty polyline, vertices are added by addVertex
+	z.push_back(z_);
+	offsets.push_back(x.size());
+}
+
+
+inline void PolylineStore::addPolyline(const double z_, const int count)
+{
+	//Add a new polyline of count vertices, its coordinates are written through getXData, getYData
+	addPolyline(z_);
+
+	x.resize(x.size() + count);
+	y.resize(y.size() + count);
+	offsets.back() += count;
+}
+
+
+inline void PolylineStore::addPolyline(const PolylineSpan& polyline)
+{
+	//Add a copy of the polyline stored in another store
+	addPolyline(polyline.getZ());
+
+	x.insert(x.end(), polyline.getXData(), polyline.getXData() + polyline.size());
+	y.insert(y.end(), polyline.getYData(), polyline.getYData() + polyline.size());
+	offsets.back() += polyline.size();
+}
+
+
+inline void PolylineStore::addVertex(const double x_, const double y_)
+{
+	//Add vertex to the last polyline
+	x.push_back(x_);
+	y.push_back(y_);
+	offsets.back()++;
+}
+
+
+inline void PolylineStore::removeDuplicateVertices(const double min_dist2)
+{
+	//Remove consecutive vertices of the last polyline closer than sqrt(min_dist2) to the previous kept vertex
+	if (z.empty())
+		return;
+
+	const int first = offsets[offsets.size() - 2], last = offsets.back();
+	int j = first;
+
+	for (int i = first; i < last; i++)
+	{
+		if ((j > first) && ((x[i] - x[j - 1]) * (x[i] - x[j - 1]) + (y[i] - y[j - 1]) * (y[i] - y[j - 1]) < min_dist2))
+			continue;
+
+		x[j] = x[i];
+		y[j] = y[i];
+		j++;
+	}
+
+	x.resize(j);
+	y.resize(j);
+	offsets.back() = j;
+}
+
+
+inline PolylineSpan PolylineStore::operator [] (const int i) const
+{
+	//Get view of the i-th polyline
+	const int first = offsets[i], count = offsets[i + 1] - offsets[i];
+
+	return PolylineSpan(std::span <const double>(x).subspan(first, count), std::span <const double>(y).subspan(first, count), z[i]);
+}
+
+#endif
@@ -0,0 +1,55 @@
+// Description: Line segments stored as a structure of arrays, batched point-segment distance kernel
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SegmentArrays_H
+#define SegmentArrays_H
+
+#include <tuple>
+
+#include "TVector.h"
+
+//Line segments stored as a structure of arrays: origin (x1, y1), direction (ux, uy) and the reciprocal
+//squared length iuu = 1 / (ux^2 + uy^2), iuu = 0 for the degenerated segment
+//The squared distance of the point and the segment is computed from the clamped projection
+//	t = min(max(((xq - x1) * ux + (yq - y1) * uy) * iuu, 0), 1), d2 = |q - x1 - t * u|^2
+//without branches and divisions. Blocks of segments are processed by AVX-512 (8 segments), AVX (4 segments)
+//or scalar code depending on the instruction set of the build; the square root is taken for the nearest segment only.
+class SegmentArrays
+{
+        public:
+                TVector <double> x1, y1;                //Origins
+                TVector <double> ux, uy;                //Directions
+                TVector <double> iuu;                   //Reciprocal squared lengths
+
+        public:
+                void push_back(const double xa, const double ya, const double xb, const double yb);
+                void reserve(const int n);
+                int size() const { return x1.size(); }
+
+                double getDistance2(const int k, const double xq, const double yq) const;
+                void getDistances2(const int first, const int count, const double xq, const double yq, double* d2) const;
+                std::tuple<int, double> findNearestSegment(const int first, const int count, const double xq, const double yq) const;
+                std::tuple<double, double> getNearestPoint(const int k, const double xq, const double yq) const;
+};
+
+#include "SegmentArrays.hpp"
+
+#endif
@@ -0,0 +1,169 @@
+// Description: Line segments stored as a structure of arrays, batched point-segment distance kernel
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SegmentArrays_HPP
+#define SegmentArrays_HPP
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(__AVX__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+
+inline void SegmentArrays::push_back(const double xa, const double ya, const double xb, const double yb)
+{
+	//Add segment given by end points
+	const double uxi = xb - xa, uyi = yb - ya;
+	const double uui = uxi * uxi + uyi * uyi;
+
+	x1.push_back(xa);
+	y1.push_back(ya);
+	ux.push_back(uxi);
+	uy.push_back(uyi);
+	iuu.push_back(uui > 0 ? 1.0 / uui : 0.0);
+}
+
+
+inline void SegmentArrays::reserve(const int n)
+{
+	//Reserve space for n segments
+	x1.reserve(n); y1.reserve(n);
+	ux.reserve(n); uy.reserve(n);
+	iuu.reserve(n);
+}
+
+
+inline double SegmentArrays::getDistance2(const int k, const double xq, const double yq) const
+{
+	//Squared distance of the point and the k-th segment
+	//The kernel is used as well, so the distance is bitwise equal to the batched one
+	double d2;
+	getDistances2(k, 1, xq, yq, &d2);
+
+	return d2;
+}
+
+
+inline void SegmentArrays::getDistances2(const int first, const int count, const double xq, const double yq, double* d2) const
+{
+	//Squared distances of the point and segments first, ..., first + count - 1
+	const int end = first + count;
+
+#if defined(__AVX512F__)
+	//Blocks of 8 segments, the last block is masked
+	const __m512d xq8 = _mm512_set1_pd(xq), yq8 = _mm512_set1_pd(yq);
+	const __m512d zero = _mm512_setzero_pd(), one = _mm512_set1_pd(1.0);
+
+	for (int k = first; k < end; k += 8)
+	{
+		const __mmask8 m = (end - k >= 8 ? 0xFF : (__mmask8)((1 << (end - k)) - 1));
+
+		const __m512d ux8 = _mm512_maskz_loadu_pd(m, &ux[k]), uy8 = _mm512_maskz_loadu_pd(m, &uy[k]);
+		const __m512d vx = _mm512_sub_pd(xq8, _mm512_maskz_loadu_pd(m, &x1[k]));
+		const __m512d vy = _mm512_sub_pd(yq8, _mm512_maskz_loadu_pd(m, &y1[k]));
+
+		__m512d t = _mm512_mul_pd(_mm512_add_pd(_mm512_mul_pd(vx, ux8), _mm512_mul_pd(vy, uy8)), _mm512_maskz_loadu_pd(m, &iuu[k]));
+		t = _mm512_min_pd(_mm512_max_pd(t, zero), one);
+
+		const __m512d dx = _mm512_sub_pd(vx, _mm512_mul_pd(t, ux8));
+		const __m512d dy = _mm512_sub_pd(vy, _mm512_mul_pd(t, uy8));
+
+		_mm512_mask_storeu_pd(d2 + k - first, m, _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy)));
+	}
+
+#elif defined(__AVX__)
+	//Blocks of 4 segments, the last block is masked
+	const __m256d xq4 = _mm256_set1_pd(xq), yq4 = _mm256_set1_pd(yq);
+	const __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd(1.0);
+
+	for (int k = first; k < end; k += 4)
+	{
+		const int r = end - k;
+		const __m256i m = _mm256_setr_epi64x(-1, (r > 1 ? -1 : 0), (r > 2 ? -1 : 0), (r > 3 ? -1 : 0));
+
+		const __m256d ux4 = _mm256_maskload_pd(&ux[k], m), uy4 = _mm256_maskload_pd(&uy[k], m);
+		const __m256d vx = _mm256_sub_pd(xq4, _mm256_maskload_pd(&x1[k], m));
+		const __m256d vy = _mm256_sub_pd(yq4, _mm256_maskload_pd(&y1[k], m));
+
+		__m256d t = _mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(vx, ux4), _mm256_mul_pd(vy, uy4)), _mm256_maskload_pd(&iuu[k], m));
+		t = _mm256_min_pd(_mm256_max_pd(t, zero), one);
+
+		const __m256d dx = _mm256_sub_pd(vx, _mm256_mul_pd(t, ux4));
+		const __m256d dy = _mm256_sub_pd(vy, _mm256_mul_pd(t, uy4));
+
+		_mm256_maskstore_pd(d2 + k - first, m, _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+	}
+
+#else
+	//Scalar version
+	for (int k = first; k < end; k++)
+	{
+		const double vx = xq - x1[k], vy = yq - y1[k];
+		const double t = std::min(std::max((vx * ux[k] + vy * uy[k]) * iuu[k], 0.0), 1.0);
+		const double dx = vx - t * ux[k], dy = vy - t * uy[k];
+
+		d2[k - first] = dx * dx + dy * dy;
+	}
+#endif
+}
+
+
+inline std::tuple<int, double> SegmentArrays::findNearestSegment(const int first, const int count, const double xq, const double yq) const
+{
+	//Find the first segment of the minimum squared distance, returns its index and squared distance
+	static const int BLOCK = 64;
+	double d2[BLOCK];
+
+	int k_min = -1;
+	double d2_min = 0;
+
+	//Process blocks of segments
+	for (int k0 = first; k0 < first + count; k0 += BLOCK)
+	{
+		const int n = std::min(BLOCK, first + count - k0);
+		getDistances2(k0, n, xq, yq, d2);
+
+		for (int i = 0; i < n; i++)
+		{
+			if ((k_min < 0) || (d2[i] < d2_min))
+			{
+				k_min = k0 + i;
+				d2_min = d2[i];
+			}
+		}
+	}
+
+	return { k_min, d2_min };
+}
+
+
+inline std::tuple<double, double> SegmentArrays::getNearestPoint(const int k, const double xq, const double yq) const
+{
+	//Nearest point of the k-th segment
+	const double vx = xq - x1[k], vy = yq - y1[k];
+	const double t = std::min(std::max((vx * ux[k] + vy * uy[k]) * iuu[k], 0.0), 1.0);
+
+	return { x1[k] + t * ux[k], y1[k] + t * uy[k] };
+}
+
+#endif
@@ -0,0 +1,66 @@
+// Description: Uniform grid of the buffer line segments, nearest segment search
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SegmentGrid_H
+#define SegmentGrid_H
+
+#include <tuple>
+
+#include "TVector.h"
+#include "PolylineStore.h"
+#include "BufferSegments.h"
+
+//Uniform grid of the line segments of the buffer fragments of both sides of the corridor
+//Segments are bucketed into all cells they cross (supercover), cells are stored contiguously (CSR layout)
+//The cell size is derived from the median segment length and the buffer height dh, the amount of cells is bounded
+//by the amount of segments. Nearest segment query searches rings of cells around the query point until
+//the minimum distance is proven by the distance of the unvisited cells.
+class SegmentGrid : public BufferSegments
+{
+        private:
+                static const int MAX_CELLS_PER_SEGMENT = 4;     //Maximum ratio of the amount of cells and segments
+
+                double x0, y0;                          //Lower left corner of the grid
+                double cell_size;                       //Size of the cell
+                int nx, ny;                             //Amount of columns and rows
+                unsigned char grid_sides;               //Bit mask of the sides of the segments
+
+                TVector <int> cell_first;               //First item of the cell, nx * ny + 1 items
+                TVector <int> cell_items;               //Segment indices sorted by cells
+                SegmentArrays cell_segments;            //Copies of the segments sorted by cells, processed by the vectorized kernel
+
+        public:
+                SegmentGrid(std::span <const PolylineSpan> buffers_dh1, std::span <const PolylineSpan> buffers_dh2, const double dh);
+
+        public:
+                TNearestPoints findNearestSegments(const double xq, const double yq) const;
+                TNearestPoints findNearestSegments(const double xq, const double yq, const int buff1, const int idx1, const int buff2, const int idx2) const;
+
+                double getCellSize() const { return cell_size; }
+
+        private:
+                TNearestSegments searchNearestSegments(const double xq, const double yq, TNearestSegments nearest) const;
+                double computeCellSize(const double dh) const;
+};
+
+#include "SegmentGrid.hpp"
+
+#endif
@@ -0,0 +1,239 @@
+// Description: Uniform grid of the buffer line segments, nearest segment search
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SegmentGrid_HPP
+#define SegmentGrid_HPP
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+
+inline SegmentGrid::SegmentGrid(std::span <const PolylineSpan> buffers_dh1, std::span <const PolylineSpan> buffers_dh2, const double dh) : BufferSegments(buffers_dh1, buffers_dh2), x0(0), y0(0), cell_size(0), nx(0), ny(0), grid_sides(0)
+{
+	//Empty grid
+	const int n = segments.size();
+	if (n == 0)
+		return;
+
+	//Sides of the segments
+	for (int i = 0; i < n; i++)
+		grid_sides |= 1 << sides[i];
+
+	//Bounding box of all segments
+	double xmax = -std::numeric_limits<double>::max(), ymax = xmax;
+	x0 = y0 = std::numeric_limits<double>::max();
+
+	for (int i = 0; i < n; i++)
+	{
+		x0 = std::min({ x0, segments.x1[i], getX2(i) });
+		y0 = std::min({ y0, segments.y1[i], getY2(i) });
+		xmax = std::max({ xmax, segments.x1[i], getX2(i) });
+		ymax = std::max({ ymax, segments.y1[i], getY2(i) });
+	}
+
+	//Cell size, enlarge the cell while there are too many cells
+	cell_size = computeCellSize(dh);
+
+	while (((xmax - x0) / cell_size + 1) * ((ymax - y0) / cell_size + 1) > (double)MAX_CELLS_PER_SEGMENT * n)
+		cell_size *= 1.5;
+
+	nx = (int)floor((xmax - x0) / cell_size) + 1;
+	ny = (int)floor((ymax - y0) / cell_size) + 1;
+
+	//Cells crossed by the segment (supercover): the segment is clipped to each column of its bounding box,
+	//rows overlapped by the clipped part are registered. The amount of cells grows with the segment length, not with its area.
+	//The rows are extended by a small tolerance, so the segments passing through the cell corners are not missed.
+	const double eps = 1.0e-9 * cell_size;
+
+	auto getColumn = [&](const double x) { return std::max(std::min((int)floor((x - x0) / cell_size), nx - 1), 0); };
+	auto getRow = [&](const double y) { return std::max(std::min((int)floor((y - y0) / cell_size), ny - 1), 0); };
+
+	auto forEachCell = [&](const int i, auto&& process)
+	{
+		const double xa = segments.x1[i], ya = segments.y1[i], xb = getX2(i), yb = getY2(i);
+		const double xl = std::min(xa, xb), xr = std::max(xa, xb);
+		const int i0 = getColumn(xl), i1 = getColumn(xr);
+
+		for (int ic = i0; ic <= i1; ic++)
+		{
+			//Part of the segment inside the column, the segment is not vertical when it crosses more columns
+			double yl = ya, yr = yb;
+
+			if (i0 != i1)
+			{
+				const double slope = (yb - ya) / (xb - xa);
+				yl = ya + (std::max(xl, x0 + ic * cell_size) - xa) * slope;
+				yr = ya + (std::min(xr, x0 + (ic + 1) * cell_size) - xa) * slope;
+			}
+
+			const int j0 = getRow(std::min(yl, yr) - eps), j1 = getRow(std::max(yl, yr) + eps);
+
+			for (int jc = j0; jc <= j1; jc++)
+				process(jc * nx + ic);
+		}
+	};
+
+	//Count segments in cells
+	cell_first.assign(nx * ny + 1, 0);
+
+	for (int i = 0; i < n; i++)
+		forEachCell(i, [&](const int c) { cell_first[c + 1]++; });
+
+	for (int c = 0; c < nx * ny; c++)
+		cell_first[c + 1] += cell_first[c];
+
+	//Fill cells, segments of the cell remain sorted by (buffer, segment)
+	TVector <int> cell_next(cell_first.begin(), cell_first.end() - 1);
+	cell_items.resize(cell_first.back());
+
+	for (int i = 0; i < n; i++)
+		forEachCell(i, [&](const int c) { cell_items[cell_next[c]++] = i; });
+
+	//Copy segments in the cell order
+	cell_segments.reserve(cell_items.size());
+
+	for (const int k : cell_items)
+	{
+		cell_segments.x1.push_back(segments.x1[k]); cell_segments.y1.push_back(segments.y1[k]);
+		cell_segments.ux.push_back(segments.ux[k]); cell_segments.uy.push_back(segments.uy[k]);
+		cell_segments.iuu.push_back(segments.iuu[k]);
+	}
+}
+
+
+inline BufferSegments::TNearestPoints SegmentGrid::findNearestSegments(const double xq, const double yq) const
+{
+	//Find nearest segments of both sides to the query point
+	//Returns buffer index, segment index, distance and the nearest point on the segment for each side
+	return getNearestPoints(searchNearestSegments(xq, yq, getEmptyNearestSegments()), xq, yq);
+}
+
+
+inline BufferSegments::TNearestPoints SegmentGrid::findNearestSegments(const double xq, const double yq, const int buff1, const int idx1, const int buff2, const int idx2) const
+{
+	//Find nearest segments of both sides to the query point, coherent query starting from the segments idx1 of the fragment buff1 and idx2 of buff2
+	//The local minima along the fragments bound the search, usually only the query cell is visited
+	return getNearestPoints(searchNearestSegments(xq, yq, walkAlongFragments(xq, yq, buff1, idx1, buff2, idx2)), xq, yq);
+}
+
+
+inline BufferSegments::TNearestSegments SegmentGrid::searchNearestSegments(const double xq, const double yq, TNearestSegments nearest) const
+{
+	//Search rings of cells outward from the query cell, the initial nearest segments of both sides are given
+	if (segments.size() == 0)
+		return nearest;
+
+	//Cell of the query point, clamped to the grid
+	const int cx = (int)std::max(std::min(floor((xq - x0) / cell_size), nx - 1.0), 0.0);
+	const int cy = (int)std::max(std::min(floor((yq - y0) / cell_size), ny - 1.0), 0.0);
+
+	//Test all segments of the cell using the vectorized kernel
+	static const int BLOCK = 64;
+	double d2[BLOCK];
+
+	auto searchCell = [&](const int ic, const int jc)
+	{
+		const int c = jc * nx + ic;
+
+		for (int k0 = cell_first[c]; k0 < cell_first[c + 1]; k0 += BLOCK)
+		{
+			const int n = std::min(BLOCK, cell_first[c + 1] - k0);
+			cell_segments.getDistances2(k0, n, xq, yq, d2);
+
+			for (int i = 0; i < n; i++)
+				updateNearestSegment(cell_items[k0 + i], d2[i], nearest);
+		}
+	};
+
+	//Search rings of cells
+	for (int r = 0; ; r++)
+	{
+		const int i0 = cx - r, i1 = cx + r, j0 = cy - r, j1 = cy + r;
+
+		for (int jc = std::max(j0, 0); jc <= std::min(j1, ny - 1); jc++)
+		{
+			//First and last row of the ring: all cells
+			if ((jc == j0) || (jc == j1))
+			{
+				for (int ic = std::max(i0, 0); ic <= std::min(i1, nx - 1); ic++)
+					searchCell(ic, jc);
+			}
+
+			//Other rows: first and last cells
+			else
+			{
+				if (i0 >= 0)
+					searchCell(i0, jc);
+
+				if ((i1 < nx) && (i1 != i0))
+					searchCell(i1, jc);
+			}
+		}
+
+		//All cells have been searched
+		const bool left = i0 > 0, right = i1 < nx - 1, bottom = j0 > 0, top = j1 < ny - 1;
+
+		if (!left && !right && !bottom && !top)
+			break;
+
+		//Minimum distance of unvisited cells
+		double d_out = std::numeric_limits<double>::max();
+
+		if (left)
+			d_out = std::min(d_out, xq - (x0 + i0 * cell_size));
+
+		if (right)
+			d_out = std::min(d_out, x0 + (i1 + 1) * cell_size - xq);
+
+		if (bottom)
+			d_out = std::min(d_out, yq - (y0 + j0 * cell_size));
+
+		if (top)
+			d_out = std::min(d_out, y0 + (j1 + 1) * cell_size - yq);
+
+		//No closer segment of any side exists
+		if (!isWithinDistance(d_out * d_out, grid_sides, nearest))
+			break;
+	}
+
+	return nearest;
+}
+
+
+inline double SegmentGrid::computeCellSize(const double dh) const
+{
+	//Cell size given by the median segment length, at least the buffer height dh
+	const int n = segments.size();
+	TVector <double> lengths(n);
+
+	for (int i = 0; i < n; i++)
+		lengths[i] = sqrt(segments.ux[i] * segments.ux[i] + segments.uy[i] * segments.uy[i]);
+
+	std::nth_element(lengths.begin(), lengths.begin() + n / 2, lengths.end());
+
+	const double cs = std::max(lengths[n / 2], dh);
+
+	//Degenerated segments
+	return (cs > 0 ? cs : 1.0);
+}
+
+#endif
@@ -0,0 +1,68 @@
+// Description: STR-packed R-tree of the buffer line segments, nearest segment search
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SegmentRTree_H
+#define SegmentRTree_H
+
+#include <tuple>
+
+#include "TVector.h"
+#include "PolylineStore.h"
+#include "BufferSegments.h"
+
+//R-tree of the line segments of the buffer fragments of both sides of the corridor
+//The tree is bulk-loaded using the Sort-Tile-Recursive (STR) packing, nodes of one level are stored contiguously
+//Nearest segment query uses the best-first search ordered by the minimum distance to the node bounding box,
+//the node is pruned when it is farther than the nearest segments of all sides it contains
+class SegmentRTree : public BufferSegments
+{
+        private:
+                //Node of the tree: bounding box and the range of children (segments for leaves)
+                struct TNode
+                {
+                        double xmin, ymin, xmax, ymax;
+                        int first, count;
+                        bool leaf;
+                        unsigned char sides;            //Bit mask of the sides of the segments
+
+                };
+
+                static const int NODE_CAPACITY = 16;    //Maximum amount of children of the node
+                static const int QUEUE_BUFFER_SIZE = 4096;      //Stack memory of the search queue in bytes
+
+                TVector <TNode> nodes;                  //Nodes, leaves first, root is the last node, segments are stored in the STR order
+
+        public:
+                SegmentRTree(std::span <const PolylineSpan> buffers_dh1, std::span <const PolylineSpan> buffers_dh2);
+
+        public:
+                TNearestPoints findNearestSegments(const double xq, const double yq) const;
+                TNearestPoints findNearestSegments(const double xq, const double yq, const int buff1, const int idx1, const int buff2, const int idx2) const;
+
+        private:
+                TNearestSegments searchNearestSegments(const double xq, const double yq, TNearestSegments nearest) const;
+                static TVector <int> sortTileRecursive(const TVector <double>& cx, const TVector <double>& cy, const int m);
+                static double getMinDistance2(const TNode& node, const double xq, const double yq);
+};
+
+#include "SegmentRTree.hpp"
+
+#endif
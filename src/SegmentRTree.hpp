@@ -0,0 +1,216 @@
+// Description: STR-packed R-tree of the buffer line segments, nearest segment search
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SegmentRTree_HPP
+#define SegmentRTree_HPP
+
+#include <cmath>
+#include <queue>
+#include <numeric>
+#include <algorithm>
+#include <limits>
+#include <functional>
+#include <cstddef>
+#include <memory_resource>
+
+
+inline SegmentRTree::SegmentRTree(std::span <const PolylineSpan> buffers_dh1, std::span <const PolylineSpan> buffers_dh2) : BufferSegments(buffers_dh1, buffers_dh2)
+{
+	//Bulk load the R-tree using the STR packing
+	const int n = segments.size();
+
+	//Empty tree
+	if (n == 0)
+		return;
+
+	//Reorder segments by STR
+	TVector <double> cx(n), cy(n);
+	for (int i = 0; i < n; i++)
+	{
+		cx[i] = segments.x1[i] + 0.5 * segments.ux[i];
+		cy[i] = segments.y1[i] + 0.5 * segments.uy[i];
+	}
+
+	reorder(sortTileRecursive(cx, cy, NODE_CAPACITY));
+
+	//Create leaves
+	const double dmax = std::numeric_limits<double>::max();
+
+	for (int i = 0; i < n; i += NODE_CAPACITY)
+	{
+		TNode node{ dmax, dmax, -dmax, -dmax, i, std::min(NODE_CAPACITY, n - i), true, 0 };
+
+		for (int j = i; j < i + node.count; j++)
+		{
+			node.sides |= 1 << sides[j];
+			node.xmin = std::min({ node.xmin, segments.x1[j], getX2(j) });
+			node.ymin = std::min({ node.ymin, segments.y1[j], getY2(j) });
+			node.xmax = std::max({ node.xmax, segments.x1[j], getX2(j) });
+			node.ymax = std::max({ node.ymax, segments.y1[j], getY2(j) });
+		}
+
+		nodes.push_back(node);
+	}
+
+	//Create upper levels until the root is found
+	int level_first = 0, level_count = nodes.size();
+
+	while (level_count > 1)
+	{
+		//Reorder nodes of the level by STR, their children are stored in the lower level
+		TVector <double> ncx(level_count), ncy(level_count);
+		for (int i = 0; i < level_count; i++)
+		{
+			ncx[i] = 0.5 * (nodes[level_first + i].xmin + nodes[level_first + i].xmax);
+			ncy[i] = 0.5 * (nodes[level_first + i].ymin + nodes[level_first + i].ymax);
+		}
+
+		const TVector <int> nperm = sortTileRecursive(ncx, ncy, NODE_CAPACITY);
+		const TVector <TNode> level(nodes.begin() + level_first, nodes.begin() + level_first + level_count);
+
+		for (int i = 0; i < level_count; i++)
+			nodes[level_first + i] = level[nperm[i]];
+
+		//Create parent nodes
+		const int next_first = nodes.size();
+
+		for (int i = 0; i < level_count; i += NODE_CAPACITY)
+		{
+			TNode node{ dmax, dmax, -dmax, -dmax, level_first + i, std::min(NODE_CAPACITY, level_count - i), false, 0 };
+
+			for (int j = node.first; j < node.first + node.count; j++)
+			{
+				node.sides |= nodes[j].sides;
+				node.xmin = std::min(node.xmin, nodes[j].xmin);
+				node.ymin = std::min(node.ymin, nodes[j].ymin);
+				node.xmax = std::max(node.xmax, nodes[j].xmax);
+				node.ymax = std::max(node.ymax, nodes[j].ymax);
+			}
+
+			nodes.push_back(node);
+		}
+
+		level_first = next_first;
+		level_count = nodes.size() - next_first;
+	}
+}
+
+
+inline BufferSegments::TNearestPoints SegmentRTree::findNearestSegments(const double xq, const double yq) const
+{
+	//Find nearest segments of both sides to the query point
+	//Returns buffer index, segment index, distance and the nearest point on the segment for each side
+	return getNearestPoints(searchNearestSegments(xq, yq, getEmptyNearestSegments()), xq, yq);
+}
+
+
+inline BufferSegments::TNearestPoints SegmentRTree::findNearestSegments(const double xq, const double yq, const int buff1, const int idx1, const int buff2, const int idx2) const
+{
+	//Find nearest segments of both sides to the query point, coherent query starting from the segments idx1 of the fragment buff1 and idx2 of buff2
+	//The local minima along the fragments bound the search, only closer nodes are visited
+	return getNearestPoints(searchNearestSegments(xq, yq, walkAlongFragments(xq, yq, buff1, idx1, buff2, idx2)), xq, yq);
+}
+
+
+inline BufferSegments::TNearestSegments SegmentRTree::searchNearestSegments(const double xq, const double yq, TNearestSegments nearest) const
+{
+	//Best-first search of the nearest segments of both sides, the initial nearest segments are given
+	if (nodes.empty())
+		return nearest;
+
+	//Priority queue of nodes ordered by the minimum distance, stored on the stack unless it is exceptionally long
+	typedef std::pair <double, int> TItem;
+	std::byte queue_buffer[QUEUE_BUFFER_SIZE];
+	std::pmr::monotonic_buffer_resource queue_memory(queue_buffer, sizeof(queue_buffer));
+	std::pmr::vector <TItem> queue_items(&queue_memory);
+	queue_items.reserve(QUEUE_BUFFER_SIZE / (2 * sizeof(TItem)));
+
+	std::priority_queue <TItem, std::pmr::vector <TItem>, std::greater <TItem> > queue(std::greater <TItem>(), std::move(queue_items));
+	queue.emplace(getMinDistance2(nodes.back(), xq, yq), nodes.size() - 1);
+
+	while (!queue.empty())
+	{
+		const auto [d2, in] = queue.top();
+		queue.pop();
+
+		const TNode& node = nodes[in];
+
+		//No closer segment of the node sides exists
+		if (!isWithinDistance(d2, node.sides, nearest))
+		{
+			//Remaining nodes are farther for all sides
+			if (!isWithinDistance(d2, nodes.back().sides, nearest))
+				break;
+
+			continue;
+		}
+
+		//Leaf: test segments
+		if (node.leaf)
+			updateNearestSegments(node.first, node.count, xq, yq, nearest);
+
+		//Inner node: add children
+		else
+		{
+			for (int i = node.first; i < node.first + node.count; i++)
+			{
+				const double d2i = getMinDistance2(nodes[i], xq, yq);
+
+				if (isWithinDistance(d2i, nodes[i].sides, nearest))
+					queue.emplace(d2i, i);
+			}
+		}
+	}
+
+	return nearest;
+}
+
+
+inline TVector <int> SegmentRTree::sortTileRecursive(const TVector <double>& cx, const TVector <double>& cy, const int m)
+{
+	//Sort-Tile-Recursive ordering of the items given by their centers
+	//Items are sorted by x, split into vertical slices of sqrt(n / m) nodes, each slice is sorted by y
+	const int n = cx.size();
+	const int nodes_count = (n + m - 1) / m;
+	const int slice_size = m * (int)ceil(sqrt((double)nodes_count));
+
+	TVector <int> perm(n);
+	std::iota(perm.begin(), perm.end(), 0);
+
+	std::sort(perm.begin(), perm.end(), [&cx](const int a, const int b) { return cx[a] < cx[b]; });
+
+	for (int i = 0; i < n; i += slice_size)
+		std::sort(perm.begin() + i, perm.begin() + std::min(i + slice_size, n), [&cy](const int a, const int b) { return cy[a] < cy[b]; });
+
+	return perm;
+}
+
+
+inline double SegmentRTree::getMinDistance2(const TNode& node, const double xq, const double yq)
+{
+	//Squared minimum distance of the point and the bounding box
+	const double dx = std::max({ node.xmin - xq, 0.0, xq - node.xmax });
+	const double dy = std::max({ node.ymin - yq, 0.0, yq - node.ymax });
+
+	return dx * dx + dy * dy;
+}
+
+#endif
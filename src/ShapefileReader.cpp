@@ -0,0 +1,200 @@
+// Description: Streaming reader of the ESRI Shapefile polylines
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "ShapefileReader.h"
+
+#include <charconv>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+#include "Const.h"
+#include "MappedFile.h"
+#include "BadDataException.h"
+#include "FileReadException.h"
+
+
+void ShapefileReader::loadPolylines(const std::string& file_name, const std::string& height_attribute, PolylineStore& polylines)
+{
+	//Load polylines of the shapefile, each part of the shape is a new polyline
+	const MappedFile shp_file(file_name);
+	const std::string_view shp = shp_file.getContent();
+
+	//Check the header
+	if ((shp.size() < SHP_HEADER_SIZE) || (readValue <int32_t>(shp.data(), true) != SHP_FILE_CODE))
+		throw FileReadException("FileReadException: invalid shapefile header, ", file_name);
+
+	const int shape_type = readValue <int32_t>(shp.data() + 32, false);
+
+	//Throw exception
+	if ((shape_type != PolyLineShape) && (shape_type != PolyLineZShape) && (shape_type != PolyLineMShape))
+		throw BadDataException("BadDataException: unsupported shape type (PolyLine, PolyLineZ, PolyLineM expected), ", file_name + ", type " + std::to_string(shape_type));
+
+	//Find the height attribute in the DBF table
+	const std::string dbf_name = std::filesystem::path(file_name).replace_extension(".dbf").string();
+	std::optional <MappedFile> dbf_file;
+
+	if (std::filesystem::exists(dbf_name))
+		dbf_file.emplace(dbf_name);
+
+	TAttribute attribute;
+	const bool has_attribute = dbf_file && findAttribute(dbf_file->getContent(), height_attribute, attribute);
+
+	//Throw exception
+	if (!has_attribute && (shape_type != PolyLineZShape))
+		throw BadDataException("BadDataException: height attribute not found in DBF file, ", file_name + ", attribute " + height_attribute);
+
+	//Process records one by one, records are walked sequentially and the .shx index is not used
+	std::size_t pos = SHP_HEADER_SIZE;
+	int record = 0;
+
+	for (; pos + 8 <= shp.size(); record++)
+	{
+		const std::size_t content_size = 2 * (std::size_t)(uint32_t)readValue <int32_t>(shp.data() + pos + 4, true);
+		const char* content = shp.data() + pos + 8;
+
+		//Throw exception
+		if (pos + 8 + content_size > shp.size())
+			throw FileReadException("FileReadException: truncated shapefile record, ", file_name + ", record " + std::to_string(record + 1));
+
+		pos += 8 + content_size;
+
+		//Skip empty shapes
+		if ((content_size < 4) || (readValue <int32_t>(content, false) == NullShape))
+			continue;
+
+		//Get height of the shape, skip deleted records
+		double z = 0.0;
+		if (has_attribute && !getAttributeValue(attribute, record, file_name, z))
+			continue;
+
+		//Amount of parts and points
+		const int parts_count = content_size >= 44 ? readValue <int32_t>(content + 36, false) : -1;
+		const int points_count = content_size >= 44 ? readValue <int32_t>(content + 40, false) : -1;
+
+		const std::size_t points_offset = 44 + 4 * (std::size_t)parts_count;
+		const std::size_t z_offset = points_offset + 16 * (std::size_t)points_count + 16;
+
+		//Throw exception
+		if ((parts_count < 0) || (points_count < 0) || (points_offset + 16 * (std::size_t)points_count > content_size) ||
+			(!has_attribute && (z_offset + 8 * (std::size_t)points_count > content_size)))
+			throw FileReadException("FileReadException: invalid shapefile record, ", file_name + ", record " + std::to_string(record + 1));
+
+		//Process parts of the shape
+		for (int i = 0; i < parts_count; i++)
+		{
+			const int first = readValue <int32_t>(content + 44 + 4 * i, false);
+			const int last = (i + 1 < parts_count) ? readValue <int32_t>(content + 48 + 4 * i, false) : points_count;
+
+			//Throw exception
+			if ((first < 0) || (first > last) || (last > points_count))
+				throw FileReadException("FileReadException: invalid part of the shapefile record, ", file_name + ", record " + std::to_string(record + 1));
+
+			//Height given by the first vertex of the part
+			if (!has_attribute && (first < last))
+				z = readValue <double>(content + z_offset + 8 * first, false);
+
+			polylines.addPolyline(z);
+
+			for (int j = first; j < last; j++)
+				polylines.addVertex(readValue <double>(content + points_offset + 16 * j, false), readValue <double>(content + points_offset + 16 * j + 8, false));
+
+			//Remove possible duplicate points
+			polylines.removeDuplicateVertices(MIN_POINT_DIST2);
+		}
+	}
+
+	//Throw exception, the DBF table must hold a record for each shape
+	if (dbf_file && (dbf_file->getContent().size() >= 32) && (readValue <uint32_t>(dbf_file->getContent().data() + 4, false) != (uint32_t)record))
+		throw BadDataException("BadDataException: amount of DBF records differs from the amount of shapes, ", file_name + ", shapes " + std::to_string(record) +
+			", DBF records " + std::to_string(readValue <uint32_t>(dbf_file->getContent().data() + 4, false)));
+}
+
+
+bool ShapefileReader::findAttribute(std::string_view dbf, const std::string& name, TAttribute& attribute)
+{
+	//Find the field of the DBF table by its name, the name is case insensitive
+	if (dbf.size() < 32)
+		return false;
+
+	const int records_count = readValue <uint32_t>(dbf.data() + 4, false);
+	const int header_size = readValue <uint16_t>(dbf.data() + 8, false);
+	const int record_size = readValue <uint16_t>(dbf.data() + 10, false);
+
+	//Field descriptors of 32 bytes are terminated by 0x0D, the deletion flag precedes the fields of the record
+	for (int i = 32, offset = 1; (i + 32 <= header_size) && (i + 32 <= (int)dbf.size()) && (dbf[i] != 0x0D); i += 32)
+	{
+		const std::string_view field_name(dbf.data() + i, strnlen(dbf.data() + i, 11));
+		const int field_size = (unsigned char)dbf[i + 16];
+
+		if (std::equal(field_name.begin(), field_name.end(), name.begin(), name.end(), [](const char a, const char b) { return tolower(a) == tolower(b); }))
+		{
+			attribute.records = dbf.substr(std::min((std::size_t)header_size, dbf.size()));
+			attribute.records_count = records_count;
+			attribute.record_size = record_size;
+			attribute.offset = offset;
+			attribute.size = field_size;
+
+			return true;
+		}
+
+		offset += field_size;
+	}
+
+	return false;
+}
+
+
+bool ShapefileReader::getAttributeValue(const TAttribute& attribute, const int record, const std::string& file_name, double& value)
+{
+	//Get numeric value of the attribute of the record, returns false for the deleted record
+	const std::size_t first = (std::size_t)record * attribute.record_size;
+
+	//Throw exception
+	if ((record >= attribute.records_count) || (first + attribute.record_size > attribute.records.size()))
+		throw BadDataException("BadDataException: missing DBF record of the shape, ", file_name + ", record " + std::to_string(record + 1));
+
+	//Deleted record
+	if (attribute.records[first] == '*')
+		return false;
+
+	//Trim the field
+	const char* p = attribute.records.data() + first + attribute.offset;
+	const char* end = p + attribute.size;
+
+	while ((p < end) && (*p == ' '))
+		p++;
+
+	while ((end > p) && (end[-1] == ' '))
+		end--;
+
+	if ((p < end) && (*p == '+'))
+		p++;
+
+	const auto [ptr, ec] = std::from_chars(p, end, value);
+
+	//Throw exception
+	if ((p == end) || (ec != std::errc()) || (ptr != end))
+		throw BadDataException("BadDataException: invalid height in DBF record, ", file_name + ", record " + std::to_string(record + 1));
+
+	return true;
+}
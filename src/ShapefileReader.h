@@ -0,0 +1,73 @@
+// Description: Streaming reader of the ESRI Shapefile polylines
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ShapefileReader_H
+#define ShapefileReader_H
+
+#include <string>
+#include <string_view>
+
+#include "PolylineStore.h"
+
+//Streaming reader of the polylines stored in the ESRI Shapefile (.shp geometry and .dbf attributes)
+//PolyLine, PolyLineZ and PolyLineM shapes are supported, each part of the shape is stored as a separate polyline.
+//The height of the polyline is given by the numeric DBF attribute (case insensitive name), the Z coordinate
+//of the first vertex of the part is used when the attribute is missing. Records of the .shp file are read
+//sequentially from the mapped file, the i-th record corresponds to the i-th DBF row, deleted rows are skipped.
+class ShapefileReader
+{
+        private:
+                static const int SHP_HEADER_SIZE = 100;         //Size of the .shp header in bytes
+                static const int SHP_FILE_CODE = 9994;          //File code in the .shp header
+
+                //Shape types
+                typedef enum
+                {
+                        NullShape = 0,
+                        PolyLineShape = 3,
+                        PolyLineZShape = 13,
+                        PolyLineMShape = 23
+                } TShapeType;
+
+                //Numeric attribute of the DBF file
+                struct TAttribute
+                {
+                        std::string_view records;       //Records of the table
+                        int records_count;              //Amount of records
+                        int record_size;                //Size of the record in bytes, including the deletion flag
+                        int offset;                     //Offset of the field in the record
+                        int size;                       //Size of the field
+                };
+
+        public:
+                static void loadPolylines(const std::string& file_name, const std::string& height_attribute, PolylineStore& polylines);
+
+        private:
+                static bool findAttribute(std::string_view dbf, const std::string& name, TAttribute& attribute);
+                static bool getAttributeValue(const TAttribute& attribute, const int record, const std::string& file_name, double& value);
+
+                template <typename T>
+                static T readValue(const char* data, const bool big_endian);
+};
+
+#include "ShapefileReader.hpp"
+
+#endif
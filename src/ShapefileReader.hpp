@@ -0,0 +1,46 @@
+// Description: Streaming reader of the ESRI Shapefile polylines
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ShapefileReader_HPP
+#define ShapefileReader_HPP
+
+#include <cstring>
+#include <bit>
+#include <algorithm>
+
+
+template <typename T>
+T ShapefileReader::readValue(const char* data, const bool big_endian)
+{
+	//Read the value stored in the given byte order
+	char bytes[sizeof(T)];
+	memcpy(bytes, data, sizeof(T));
+
+	if (big_endian != (std::endian::native == std::endian::big))
+		std::reverse(bytes, bytes + sizeof(T));
+
+	T value;
+	memcpy(&value, bytes, sizeof(T));
+
+	return value;
+}
+
+#endif
@@ -0,0 +1,223 @@
+// Description: Streaming writer of the ESRI Shapefile polylines
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "ShapefileWriter.h"
+
+#include <limits>
+#include <charconv>
+#include <cstdint>
+#include <algorithm>
+#include <filesystem>
+#include <chrono>
+
+#include "BadDataException.h"
+#include "FileWriteException.h"
+
+
+ShapefileWriter::ShapefileWriter(const std::string& file_name_) : file_name(file_name_), records(0), shp_size(SHP_HEADER_SIZE),
+	xmin(std::numeric_limits<double>::max()), ymin(std::numeric_limits<double>::max()), zmin(std::numeric_limits<double>::max()),
+	xmax(-std::numeric_limits<double>::max()), ymax(-std::numeric_limits<double>::max()), zmax(-std::numeric_limits<double>::max())
+{
+	//Create .shp, .shx and .dbf files, headers are patched by close()
+	std::filesystem::path path(file_name);
+
+	shp.open(path.replace_extension(".shp"), std::ios::out | std::ios::binary);
+	shx.open(path.replace_extension(".shx"), std::ios::out | std::ios::binary);
+	dbf.open(path.replace_extension(".dbf"), std::ios::out | std::ios::binary);
+
+	//Throw exception
+	if (!shp.is_open() || !shx.is_open() || !dbf.is_open())
+		throw FileWriteException("FileWriteException: can not write the file: ", file_name);
+
+	writeHeaders();
+}
+
+
+void ShapefileWriter::addPolyline(const PolylineSpan& polyline, const int source_id)
+{
+	//Write the polyline as one PolyLineZ record of one part, shapefile polyline needs at least 2 vertices
+	const int n = polyline.size();
+
+	if (n < 2)
+		return;
+
+	//Bounding box of the polyline
+	const double z = polyline.getZ();
+	const auto [x_first, x_last] = std::minmax_element(polyline.getXData(), polyline.getXData() + n);
+	const auto [y_first, y_last] = std::minmax_element(polyline.getYData(), polyline.getYData() + n);
+
+	//DBF record: deletion flag, height and source id aligned to the right
+	//Values are formatted before the geometry is written, the value exceeding its field is not truncated
+	char row[1 + HEIGHT_SIZE + ID_SIZE];
+	memset(row, ' ', sizeof(row));
+
+	char text[64];
+	const char* last = std::to_chars(text, text + sizeof(text), z, std::chars_format::fixed, HEIGHT_DECIMALS).ptr;
+
+	//Throw exception
+	if (last - text > HEIGHT_SIZE)
+		throw BadDataException("BadDataException: height exceeds the DBF field, ", "z = " + std::string(text, last - text));
+
+	memcpy(row + 1 + HEIGHT_SIZE - (last - text), text, last - text);
+
+	last = std::to_chars(text, text + sizeof(text), source_id).ptr;
+
+	//Throw exception
+	if (last - text > ID_SIZE)
+		throw BadDataException("BadDataException: source id exceeds the DBF field, ", "id = " + std::string(text, last - text));
+
+	memcpy(row + 1 + HEIGHT_SIZE + ID_SIZE - (last - text), text, last - text);
+
+	//Record header: record number and content length in 16-bit words, big endian
+	const int content_size = 44 + 4 + 16 * n + 16 + 8 * n;
+	record.resize(8 + content_size);
+
+	char* p = record.data();
+	p = writeValue <int32_t>(p, records + 1, true);
+	p = writeValue <int32_t>(p, content_size / 2, true);
+
+	//Shape type, bounding box, one part starting at the first point
+	p = writeValue <int32_t>(p, POLYLINEZ_SHAPE, false);
+	p = writeValue(p, *x_first, false);
+	p = writeValue(p, *y_first, false);
+	p = writeValue(p, *x_last, false);
+	p = writeValue(p, *y_last, false);
+	p = writeValue <int32_t>(p, 1, false);
+	p = writeValue <int32_t>(p, n, false);
+	p = writeValue <int32_t>(p, 0, false);
+
+	//Points
+	for (int i = 0; i < n; i++)
+	{
+		p = writeValue(p, polyline.getX(i), false);
+		p = writeValue(p, polyline.getY(i), false);
+	}
+
+	//Z range and Z values
+	p = writeValue(p, z, false);
+	p = writeValue(p, z, false);
+
+	for (int i = 0; i < n; i++)
+		p = writeValue(p, z, false);
+
+	shp.write(record.data(), record.size());
+
+	//Index record: offset and content length in 16-bit words
+	char index[8];
+	writeValue <int32_t>(writeValue <int32_t>(index, (int32_t)(shp_size / 2), true), content_size / 2, true);
+	shx.write(index, sizeof(index));
+
+	dbf.write(row, sizeof(row));
+
+	//Update bounding box of all polylines
+	xmin = std::min(xmin, *x_first);
+	ymin = std::min(ymin, *y_first);
+	zmin = std::min(zmin, z);
+	xmax = std::max(xmax, *x_last);
+	ymax = std::max(ymax, *y_last);
+	zmax = std::max(zmax, z);
+
+	shp_size += record.size();
+	records++;
+
+	checkFiles();
+}
+
+
+void ShapefileWriter::close()
+{
+	//Terminate the DBF table, patch headers and close files
+	dbf.put(0x1A);
+	writeHeaders();
+
+	shp.close();
+	shx.close();
+	dbf.close();
+
+	checkFiles();
+}
+
+
+void ShapefileWriter::writeHeaders()
+{
+	//Write headers of the .shp, .shx and .dbf files at their beginnings, records follow the headers
+	//Empty file has the zero bounding box
+	const bool empty = (records == 0);
+	char header[SHP_HEADER_SIZE];
+	memset(header, 0, sizeof(header));
+
+	writeValue <int32_t>(header, SHP_FILE_CODE, true);
+	writeValue <int32_t>(header + 28, SHP_VERSION, false);
+	writeValue <int32_t>(header + 32, POLYLINEZ_SHAPE, false);
+
+	char* p = header + 36;
+	for (const double v : { xmin, ymin, xmax, ymax, zmin, zmax })
+		p = writeValue(p, empty ? 0.0 : v, false);
+
+	//File lengths in 16-bit words
+	const std::size_t shx_size = SHP_HEADER_SIZE + 8 * (std::size_t)records;
+
+	for (auto [file, size] : { std::pair <std::ofstream*, std::size_t>(&shp, shp_size), std::pair <std::ofstream*, std::size_t>(&shx, shx_size) })
+	{
+		writeValue <int32_t>(header + 24, (int32_t)(size / 2), true);
+
+		file->seekp(0);
+		file->write(header, sizeof(header));
+	}
+
+	//DBF header, fields Contour (height) and SourceId
+	char dbf_header[32 + 2 * 32 + 1];
+	memset(dbf_header, 0, sizeof(dbf_header));
+
+	//Version and the date of the last update (years since 1900, month, day)
+	const std::chrono::year_month_day date(std::chrono::floor <std::chrono::days>(std::chrono::system_clock::now()));
+
+	dbf_header[0] = 0x03;
+	dbf_header[1] = (char)((int)date.year() - 1900);
+	dbf_header[2] = (char)(unsigned int)date.month();
+	dbf_header[3] = (char)(unsigned int)date.day();
+	writeValue <uint32_t>(dbf_header + 4, records, false);
+	writeValue <uint16_t>(dbf_header + 8, sizeof(dbf_header), false);
+	writeValue <uint16_t>(dbf_header + 10, 1 + HEIGHT_SIZE + ID_SIZE, false);
+
+	memcpy(dbf_header + 32, "Contour", 7);
+	dbf_header[32 + 11] = 'F';
+	dbf_header[32 + 16] = HEIGHT_SIZE;
+	dbf_header[32 + 17] = HEIGHT_DECIMALS;
+
+	memcpy(dbf_header + 64, "SourceId", 8);
+	dbf_header[64 + 11] = 'N';
+	dbf_header[64 + 16] = ID_SIZE;
+
+	dbf_header[96] = 0x0D;
+
+	dbf.seekp(0);
+	dbf.write(dbf_header, sizeof(dbf_header));
+}
+
+
+void ShapefileWriter::checkFiles()
+{
+	//Throw exception
+	if (shp.fail() || shx.fail() || dbf.fail())
+		throw FileWriteException("FileWriteException: can not write the file: ", file_name);
+}
+
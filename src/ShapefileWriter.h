@@ -0,0 +1,73 @@
+// Description: Streaming writer of the ESRI Shapefile polylines
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ShapefileWriter_H
+#define ShapefileWriter_H
+
+#include <string>
+#include <fstream>
+
+#include "TVector.h"
+#include "PolylineStore.h"
+#include "ContourLinesSink.h"
+
+//Streaming writer of the polylines to the PolyLineZ ESRI Shapefile (.shp, .shx, .dbf)
+//Each polyline is written as one record when it is added, only the bounding box and the amount of records are kept.
+//Headers of all files are written as placeholders and patched by close(): file lengths, bounding box, amount of DBF records.
+//The DBF table contains the height of the polyline (Contour, readable by ShapefileReader) and the id of its source polyline.
+class ShapefileWriter : public ContourLinesSink
+{
+        private:
+                static const int SHP_HEADER_SIZE = 100;         //Size of the .shp and .shx headers in bytes
+                static const int SHP_FILE_CODE = 9994;          //File code in the .shp header
+                static const int SHP_VERSION = 1000;            //Version in the .shp header
+                static const int POLYLINEZ_SHAPE = 13;          //Shape type PolyLineZ
+                static const int HEIGHT_SIZE = 19;              //Width of the height field in the DBF table
+                static const int HEIGHT_DECIMALS = 11;          //Decimal places of the height field
+                static const int ID_SIZE = 10;                  //Width of the source id field
+
+                std::string file_name;                          //Name of the .shp file
+                std::ofstream shp, shx, dbf;
+                TVector <char> record;                          //Buffer of the current record
+                int records;                                    //Amount of written records
+                std::size_t shp_size;                           //Size of the .shp file in bytes
+                double xmin, ymin, zmin, xmax, ymax, zmax;      //Bounding box of all polylines
+
+        public:
+                ShapefileWriter(const std::string& file_name_);
+                ShapefileWriter(const ShapefileWriter&) = delete;
+                ShapefileWriter& operator = (const ShapefileWriter&) = delete;
+
+        public:
+                void addPolyline(const PolylineSpan& polyline, const int source_id) override;
+                void close() override;
+
+        private:
+                void writeHeaders();
+                void checkFiles();
+
+                template <typename T>
+                static char* writeValue(char* data, const T value, const bool big_endian);
+};
+
+#include "ShapefileWriter.hpp"
+
+#endif
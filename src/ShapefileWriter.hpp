@@ -1,4 +1,4 @@
-// Description: Comparision of two points according to their planar coordinates
+// Description: Streaming writer of the ESRI Shapefile polylines
 
 // Copyright (c) 2021 - 2023
 // Tomas Bayer
@@ -19,19 +19,25 @@
 // along with this library. If not, see <http://www.gnu.org/licenses/>.
 
 
-#ifndef isEqualPointByPlanarCoordinates_H
-#define isEqualPointByPlanarCoordinates_H
 
-//Comparator, are two points equal by planar coordinates?
-template <typename Point>
-class isEqualPointByPlanarCoordinates
+#ifndef ShapefileWriter_HPP
+#define ShapefileWriter_HPP
+
+#include <cstring>
+#include <bit>
+#include <algorithm>
+
+
+template <typename T>
+char* ShapefileWriter::writeValue(char* data, const T value, const bool big_endian)
 {
-        public:
-                bool operator() ( const Point & p1, const Point & p2 ) const
-                {
-                        return *p1 == *p2;
-                }
-};
+	//Write the value in the given byte order, returns the position after the value
+	memcpy(data, &value, sizeof(T));
+
+	if (big_endian != (std::endian::native == std::endian::big))
+		std::reverse(data, data + sizeof(T));
 
+	return data + sizeof(T);
+}
 
 #endif
@@ -27,27 +27,38 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
-#include <memory>
 #include <format>
 #include <string>
 #include <filesystem>
+#include <optional>
 
 #include "Exception.h"
 #include "TVector.h"
 #include "TVector2D.h"
+#include "PolylineStore.h"
 #include "File.h"
+#include "UringFileReader.h"
 #include "ContourLinesSimplify.h"
+#include "BufferCatalog.h"
 #include "DXFExport.h"
+#include "DXFSink.h"
+#include "ShapefileWriter.h"
+#include "CSVSink.h"
+#include "AsyncContourLinesSink.h"
 #include "SplineSmoothing.h"
 
 
 int main(int argc, char* argv[])
 {
 	//Initial parameters of the contour lines and the simplification
-	bool weighted = false, scaled = false;
-	int min_points = 20, k = 2, ns = 2000;
+	bool weighted = false, scaled = false, benchmark = false, uring = false, multiple = false, recursive = false;
+	int min_points = 20, k = 2, ns = 2000, threads = 0;
 	double z_min = 0.0, z_max = 1000.0, dh = 0.20;
 	double lambda1 = 6000.0, lambda2 = 2.0;
+	TNearestNeighborsIndex nn_index = RTreeIndex;
+	TDXFEntityType dxf_entity = DXFLines;
+	bool dxf_binary = false;
+	bool export_dxf = true, export_shp = false, export_csv = false;
 	
 	//Path to the folder
 	//std::filesystem::current_path("..//results//");
@@ -66,6 +77,9 @@ int main(int argc, char* argv[])
 	//Output file name
 	std::string output_file_name = "contours.xyz";
 
+	//Height attribute of the shapefiles
+	std::string height_attribute = "Contour";
+
 	//Process command-line argument:
 	while (--argc > 0)
 	{
@@ -92,6 +106,34 @@ int main(int argc, char* argv[])
 						break;
 					}
 
+					//Benchmark of the nearest neighbor search
+					case 'b':
+					{
+						benchmark = true;
+						break;
+					}
+
+					//Read input files in batches using io_uring
+					case 'u':
+					{
+						uring = true;
+						break;
+					}
+
+					//Input files hold multiple polylines
+					case 'm':
+					{
+						multiple = true;
+						break;
+					}
+
+					//Search input files in subfolders
+					case 'r':
+					{
+						recursive = true;
+						break;
+					}
+
 					//Terminate character \0 of the argument
 					case '\0':
 						break;
@@ -157,6 +199,78 @@ int main(int argc, char* argv[])
 				ns = std::max(std::min(atoi(value), 10000), 500);
 			}
 
+			//Set amount of threads loading the input files
+			else if (!strcmp("threads", attribute))
+			{
+				threads = std::max(std::min(atoi(value), 256), 0);
+			}
+
+			//Set spatial index of the nearest neighbor search
+			else if (!strcmp("nn", attribute))
+			{
+				if (!strcmp("tree", value))
+					nn_index = RTreeIndex;
+
+				else if (!strcmp("grid", value))
+					nn_index = GridIndex;
+
+				else
+					throw Exception("Exception: Invalid nearest neighbor index in command line!");
+			}
+
+			//Set entities of the exported contour lines
+			else if (!strcmp("dxf", attribute))
+			{
+				if (!strcmp("lines", value))
+					dxf_entity = DXFLines;
+
+				else if (!strcmp("lwpolyline", value))
+					dxf_entity = DXFLWPolylines;
+
+				else if (!strcmp("polyline", value))
+					dxf_entity = DXFPolylines;
+
+				else
+					throw Exception("Exception: Invalid DXF entity in command line!");
+			}
+
+			//Set ASCII or binary DXF
+			else if (!strcmp("dxf_format", attribute))
+			{
+				if (!strcmp("ascii", value))
+					dxf_binary = false;
+
+				else if (!strcmp("binary", value))
+					dxf_binary = true;
+
+				else
+					throw Exception("Exception: Invalid DXF format in command line!");
+			}
+
+			//Set formats of the exported contour lines, comma separated list
+			else if (!strcmp("export", attribute))
+			{
+				export_dxf = export_shp = export_csv = false;
+
+				for (char* format = strtok(value, ","); format != NULL; format = strtok(NULL, ","))
+				{
+					if (!strcmp("dxf", format))
+						export_dxf = true;
+
+					else if (!strcmp("shp", format))
+						export_shp = true;
+
+					else if (!strcmp("csv", format))
+						export_csv = true;
+
+					else if (!strcmp("all", format))
+						export_dxf = export_shp = export_csv = true;
+
+					else
+						throw Exception("Exception: Invalid export format in command line!");
+				}
+			}
+
 			//Set buffer 1 file
 			else if (!strcmp("buff1", attribute))
 			{
@@ -175,6 +289,12 @@ int main(int argc, char* argv[])
 				contours_file_mask = value;
 			}
 
+			//Set height attribute of the shapefiles
+			else if (!strcmp("height", attribute))
+			{
+				height_attribute = value;
+			}
+
 			//Set file name
 			else if (!strcmp("file", attribute))
 			{
@@ -212,51 +332,101 @@ int main(int argc, char* argv[])
 		"  Smoothing order = " << k << '\n' <<
 		"  Weighted = " << weighted << '\n' <<
 		"  Scaled = " << scaled << '\n' <<
+		"  NN index = " << (nn_index == RTreeIndex ? "tree" : "grid") << '\n' <<
+		"  Threads = " << threads << (threads == 0 ? " (all hardware threads)" : "") << '\n' <<
+		"  Reader = " << (!uring ? "threads" : UringFileReader::isAvailable() ? "io_uring" : "threads (io_uring is not available)") << '\n' <<
+		"  DXF entities = " << (dxf_entity == DXFLines ? "lines" : dxf_entity == DXFLWPolylines ? "lwpolyline" : "polyline") << (dxf_binary ? ", binary" : ", ASCII") << '\n' <<
+		"  Export =" << (export_dxf ? " DXF" : "") << (export_shp ? " Shapefile" : "") << (export_csv ? " CSV" : "") << '\n' <<
+		"  Multiple polylines per file = " << multiple << '\n' <<
+		"  Shapefile height attribute = " << height_attribute << '\n' <<
 		"  Contour mask =" << contours_file_mask << '\n' <<
 		"  Buffer 1 mask = " << buff1_file_mask << '\n' <<
 		"  Buffer 2 mask = " << buff2_file_mask << '\n' <<
 		"  Output file = " << output_file_name << '\n' <<
-		"  Path = " << path << '\n' << "\n";
-
-	//Find contour line files
-	std::cout << ">>> Read input files: ";
-	TVector <std::string> cont_files;
-	File::findFilesInDirByMask(path, contours_file_mask, 1, cont_files);
+		"  Path = " << path << (recursive ? " (including subfolders)" : "") << '\n' << "\n";
 
-	//Load contours one by one
-	TVector2D <std::shared_ptr <Point3D > > contours_polylines;
-	File::loadContours(cont_files, contours_polylines);
+	try
+	{
+		//Find contour line and buffer files in one scan of the folder
+		std::cout << ">>> Read input files: ";
+		TVector2D <std::string> input_files;
+		File::findFilesInDirByMasks(path, { contours_file_mask, buff1_file_mask, buff2_file_mask }, true, recursive, input_files);
 
-	//Find buffer 1 files
-	TVector <std::string> buff1_files;
-	File::findFilesInDirByMask(path, buff1_file_mask, 1, buff1_files);
+		//Load contours
+		PolylineStore contours_polylines;
+		File::loadContours(input_files[0], contours_polylines, threads, uring, multiple, height_attribute);
 
-	//Load first buffer one by one
-	std::multimap <double, TVector < std::shared_ptr < Point3D > > > contour_buffers1;
-	File::loadBuffers(buff1_files, contour_buffers1);
+		//Load first buffer
+		PolylineStore contour_buffers1;
+		File::loadBuffers(input_files[1], contour_buffers1, threads, uring, multiple, height_attribute);
 
-	//Find buffer 2 files
-	TVector <std::string> buff2_files;
-	File::findFilesInDirByMask(path, buff2_file_mask, 1, buff2_files);
+		//Load second buffer
+		PolylineStore contour_buffers2;
+		File::loadBuffers(input_files[2], contour_buffers2, threads, uring, multiple, height_attribute);
+		std::cout << "OK \n";
 
-	//Load second buffer one by one
-	std::multimap <double, TVector < std::shared_ptr < Point3D > > > contour_buffers2;
-	File::loadBuffers(buff2_files, contour_buffers2);
-	std::cout << "OK \n";
+		//Catalog of the buffers sorted by height
+		BufferCatalog buffers(contour_buffers1, contour_buffers2, dh, min_points);
 
-	//Simplify contour lines
-	try
-	{
-		//Patial displacement with axial spline
-		TVector2D <std::shared_ptr <Point3D > > contours_polylines_smooth = ContourLinesSimplify::smoothContourLinesBySplineE(contours_polylines, contour_buffers1, contour_buffers2, dh, min_points,lambda1, lambda2, ns, k, weighted, scaled);
+		//Compare nearest neighbor searches
+		if (benchmark)
+		{
+			ContourLinesSimplify::benchmarkNearestNeighbors(contours_polylines, buffers, dh, min_points);
+			return 0;
+		}
 
-		//Export simplified contour lines to DXF
+		//Create sinks of the simplified contour lines, the file name contains the values of input parameters
 		std::string file_name_simp = "results_" + output_file_name + "_simp_dh_" + std::format("{:.2f}", dh) + "_lambda1_"
 			+ std::format("{:.2f}", lambda1) + "_lambda2_" + std::format("{:.2f}", lambda2) + "_ns_"
 			+ std::format("{:1}", int(ns)) + +"_k_" + std::format("{:1}", int(k)) + "_weighted_" 
-			+ std::format("{:1}", int(weighted)) + "_scaled_" + std::format("{:1}", int(scaled)) + ".dxf";
-		
-		DXFExport::exportContourLinesToDXF(file_name_simp, contours_polylines_smooth, 10.0);
+			+ std::format("{:1}", int(weighted)) + "_scaled_" + std::format("{:1}", int(scaled));
+
+		std::optional <DXFSink> dxf_sink;
+		std::optional <ShapefileWriter> shp_sink;
+		std::optional <CSVSink> csv_sink;
+		TVector <ContourLinesSink*> sinks;
+		TVector <std::string> output_files;
+
+		try
+		{
+			//Create sinks, files of the sinks created before the failed one are removed too
+			if (export_dxf)
+			{
+				output_files.push_back(file_name_simp + ".dxf");
+				sinks.push_back(&dxf_sink.emplace(file_name_simp + ".dxf", dxf_entity, dxf_binary));
+			}
+
+			if (export_shp)
+			{
+				output_files.insert(output_files.end(), { file_name_simp + ".shp", file_name_simp + ".shx", file_name_simp + ".dbf" });
+				sinks.push_back(&shp_sink.emplace(file_name_simp + ".shp"));
+			}
+
+			if (export_csv)
+			{
+				output_files.push_back(file_name_simp + ".csv");
+				sinks.push_back(&csv_sink.emplace(file_name_simp + ".csv"));
+			}
+
+			//Patial displacement with axial spline, smoothed contour lines are exported by the writer thread as they are finished
+			AsyncContourLinesSink contours_writer(sinks);
+			ContourLinesSimplify::smoothContourLinesBySplineE(contours_polylines, buffers, dh, min_points,lambda1, lambda2, ns, k, weighted, scaled, nn_index, contours_writer);
+			contours_writer.close();
+		}
+
+		//Creating sinks, smoothing or writing failed: the writer thread is stopped, close the files and remove them, they are not complete
+		catch (...)
+		{
+			dxf_sink.reset();
+			shp_sink.reset();
+			csv_sink.reset();
+
+			std::error_code error;
+			for (const std::string& f : output_files)
+				std::filesystem::remove(f, error);
+
+			throw;
+		}
 	}
 
 	//Throw exception
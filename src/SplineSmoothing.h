@@ -22,33 +22,34 @@
 #ifndef SplineSmoothing_H
 #define SplineSmoothing_H
 
+#include <tuple>
+#include <memory_resource>
 #include <Eigen/Dense>                               
-#include <Eigen/Sparse>                              
 #include <Eigen/Core>
 
+#include "TVector.h"
+#include "BandedLDLT.h"
+#include "BandedLDLTCache.h"
+
 //Contour line smoothing using axial spline
+//Coordinates, buffer points and weights (diagonal of W) are passed as dense vectors or Eigen::Map views of the caller's arrays
+//Smoothed coordinates XS, YS are written into the caller's vectors of the size of X
+//Temporaries are allocated from the given memory resource, e.g. the arena of the contour part
 class SplineSmoothing
 {
         public:
                
                 template <typename T>
-                static std::tuple<Eigen::SparseMatrix <T>, Eigen::SparseMatrix <T> > smoothPolylineInCorridorAsLS(const Eigen::SparseMatrix<T>& X, const Eigen::SparseMatrix<T>& Y, const Eigen::SparseMatrix<T>& X1, const Eigen::SparseMatrix<T>& Y1, const Eigen::SparseMatrix<T>& X2, const Eigen::SparseMatrix<T>& Y2, const Eigen::SparseMatrix<T>& W, const T lambda1, const T lambda2, const int k);
-
-                template <typename T>
-                static std::tuple<Eigen::SparseMatrix <T>, Eigen::SparseMatrix <T> > smoothPolylineInCorridorAsLSS(const Eigen::SparseMatrix<T>& X, const Eigen::SparseMatrix<T>& Y, const Eigen::SparseMatrix<T>& X1, const Eigen::SparseMatrix<T>& Y1, const Eigen::SparseMatrix<T>& X2, const Eigen::SparseMatrix<T>& Y2, const Eigen::SparseMatrix<T>& W, const T lambda1, const T lambda2, const int k);
+                static void smoothPolylineInCorridorAsLS(const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X1, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y1, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X2, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y2, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& W, BandedLDLT <T>& ldlt, const T lambda1, const T lambda2, const int k, Eigen::Ref <Eigen::Matrix <T, Eigen::Dynamic, 1> > XS, Eigen::Ref <Eigen::Matrix <T, Eigen::Dynamic, 1> > YS, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
 
                 template <typename T>
-                static std::tuple<Eigen::SparseMatrix <T>, Eigen::SparseMatrix <T> > smoothPolylineInCorridorAsLSS2(const Eigen::SparseMatrix<T>& X, const Eigen::SparseMatrix<T>& Y, const Eigen::SparseMatrix<T>& X1, const Eigen::SparseMatrix<T>& Y1, const Eigen::SparseMatrix<T>& X2, const Eigen::SparseMatrix<T>& Y2, const Eigen::SparseMatrix<T>& W, const T lambda1, const T lambda2, const int k);
-
-                //template <typename T>
-                //static std::tuple<Eigen::SparseMatrix <T>, Eigen::SparseMatrix <T> > smoothPolylineInCorridorAsLSS3(const Eigen::SparseMatrix<T>& X, const Eigen::SparseMatrix<T>& Y, const Eigen::SparseMatrix<T>& X1, const Eigen::SparseMatrix<T>& Y1, const Eigen::SparseMatrix<T>& X2, const Eigen::SparseMatrix<T>& Y2, const Eigen::SparseMatrix<T>& W, const T lambda1, const T lambda2, const int k);
-
+                static void smoothPolylineInCorridorAsLSS(const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X1, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y1, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X2, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y2, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& W, BandedLDLT <T>& ldlt, const T lambda1, const T lambda2, const int k, Eigen::Ref <Eigen::Matrix <T, Eigen::Dynamic, 1> > XS, Eigen::Ref <Eigen::Matrix <T, Eigen::Dynamic, 1> > YS, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
 
                 template <typename T>
-                static std::tuple<Eigen::SparseMatrix <T>, Eigen::SparseMatrix <T> > smoothPolylineInCorridorAsLS(const Eigen::SparseMatrix<T>& X, const Eigen::SparseMatrix<T>& Y, const Eigen::SparseMatrix<T>& X1, const Eigen::SparseMatrix<T>& Y1, const Eigen::SparseMatrix<T>& X2, const Eigen::SparseMatrix<T>& Y2, const Eigen::SparseMatrix<T>& W, const Eigen::SparseMatrix<T>& I0, const T lambda1, const T lambda2, const int k);
+                static void smoothPolylineInCorridorAsLSS2(const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X1, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y1, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X2, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y2, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& W, BandedLDLT <T>& ldlt, const T lambda1, const T lambda2, const int k, Eigen::Ref <Eigen::Matrix <T, Eigen::Dynamic, 1> > XS, Eigen::Ref <Eigen::Matrix <T, Eigen::Dynamic, 1> > YS, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
 
                 template <typename T>
-                static Eigen::SparseMatrix<T> diff(Eigen::SparseMatrix<T> E, const int k);
+                static void smoothPolylineInCorridorAsLS(const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X1, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y1, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X2, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y2, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& W, BandedLDLTCache <T>& ldlt_cache, const T lambda1, const T lambda2, const int k, Eigen::Ref <Eigen::Matrix <T, Eigen::Dynamic, 1> > XS, Eigen::Ref <Eigen::Matrix <T, Eigen::Dynamic, 1> > YS, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
 
 };
 
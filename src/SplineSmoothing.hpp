@@ -22,173 +22,150 @@
 #ifndef SplineSmoothing_HPP
 #define SplineSmoothing_HPP
 
- 
+#include <cmath>
+#include <algorithm>
+
+
 template <typename T>
-std::tuple<Eigen::SparseMatrix <T>, Eigen::SparseMatrix <T> > SplineSmoothing::smoothPolylineInCorridorAsLS(const Eigen::SparseMatrix <T>& X, const Eigen::SparseMatrix <T>& Y, const Eigen::SparseMatrix <T>& X1, const Eigen::SparseMatrix <T>& Y1, const Eigen::SparseMatrix <T>& X2, const Eigen::SparseMatrix <T>& Y2, const Eigen::SparseMatrix <T>& W, const T lambda1, const T lambda2, const int k)
+void SplineSmoothing::smoothPolylineInCorridorAsLS(const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X1, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y1, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X2, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y2, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& W, BandedLDLT <T>& ldlt, const T lambda1, const T lambda2, const int k, Eigen::Ref <Eigen::Matrix <T, Eigen::Dynamic, 1> > XS, Eigen::Ref <Eigen::Matrix <T, Eigen::Dynamic, 1> > YS, std::pmr::memory_resource* memory)
 {
 	//Spline smoothing with the constraints (Eigen version).
 	//Non-scaled version, asymetric least squares
-	const unsigned int m = X.rows();
-
-	//Create initial matrices
-	Eigen::SparseMatrix <T> E(m, m);
-	Eigen::SimplicialLDLT<Eigen::SparseMatrix<T> > solver(E);
-	E.setIdentity();
-	const auto D = diff(E, k);
-	
-	//Inverse
-	const auto DT = D.transpose();
-	solver.compute(W + lambda1 * DT * D + 2.0 * lambda2 * E);
-	const auto I = solver.solve(E);
-
-	//Solution of AXS
-	const auto XS = I * (W * X + lambda2 * (X1 + X2));
-	const auto YS = I * (W * Y + lambda2 * (Y1 + Y2));
-
-	return { XS, YS };
+	const int m = X.rows();
+
+	//Diagonal part of the matrix W + lambda1 * D' * D + 2 * lambda2 * E
+	std::pmr::vector <T> a(m, memory);
+	for (int i = 0; i < m; i++)
+		a[i] = W(i) + 2.0 * lambda2;
+
+	//Banded LDLT factorization, half bandwidth k, reuse the pattern of the previous part
+	if (!ldlt.isPatternAnalyzed(m, lambda1, k))
+		ldlt.analyzePattern(m, lambda1, k);
+
+	ldlt.factorize(a);
+
+	//Solution of AXS, X and Y in one pass
+	std::pmr::vector <T> b(2 * m, memory);
+	Eigen::Map <Eigen::Matrix <T, Eigen::Dynamic, 2, Eigen::RowMajor> > B(b.data(), m, 2);
+	B.col(0) = W.cwiseProduct(X) + lambda2 * (X1 + X2);
+	B.col(1) = W.cwiseProduct(Y) + lambda2 * (Y1 + Y2);
+
+	ldlt.solveInPlace(B);
+
+	XS = B.col(0);
+	YS = B.col(1);
 }
 
 
 template <typename T>
-std::tuple<Eigen::SparseMatrix <T>, Eigen::SparseMatrix <T> > SplineSmoothing::smoothPolylineInCorridorAsLSS(const Eigen::SparseMatrix <T>& X, const Eigen::SparseMatrix <T>& Y, const Eigen::SparseMatrix <T>& X1, const Eigen::SparseMatrix <T>& Y1, const Eigen::SparseMatrix <T>& X2, const Eigen::SparseMatrix <T>& Y2, const Eigen::SparseMatrix <T>& W, const T lambda1, const T lambda2, const int k)
+void SplineSmoothing::smoothPolylineInCorridorAsLSS(const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X1, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y1, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X2, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y2, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& W, BandedLDLT <T>& ldlt, const T lambda1, const T lambda2, const int k, Eigen::Ref <Eigen::Matrix <T, Eigen::Dynamic, 1> > XS, Eigen::Ref <Eigen::Matrix <T, Eigen::Dynamic, 1> > YS, std::pmr::memory_resource* memory)
 {
 	//Spline smoothing with the constraints (Eigen version)
 	//Scaled version, asymetric least squares
-	const unsigned int m = X.rows();
+	const int m = X.rows();
 
-	//Create initial matrices
-	Eigen::SparseMatrix <T> E(m, m), ZX(m, m), ZY(m, m);
-	Eigen::SimplicialLDLT<Eigen::SparseMatrix<T> > solverx(E), solvery(E);
-	E.setIdentity();
-	const auto D = diff(E, k);
-
-	//Compute elements of ZX, ZY scaling matrices
+	//Compute squared elements of ZX, ZY diagonal scaling matrices
 	const double min_element = 0.01;
+	std::pmr::vector <T> zx2(m, memory), zy2(m, memory);
+	Eigen::Map <Eigen::Matrix <T, Eigen::Dynamic, 1> > ZX2(zx2.data(), m), ZY2(zy2.data(), m);
+	for (int i = 0; i < m; i++)
+	{
+		const double dx = std::max(fabs(X1(i) - X2(i)), min_element);
+		const double dy = std::max(fabs(Y1(i) - Y2(i)), min_element);
+		ZX2(i) = 1.0 / (dx * dx);
+		ZY2(i) = 1.0 / (dy * dy);
+	}
+
+	//Diagonal parts of the matrices ZX' * W * ZX + lambda1 * D' * D + 2 * lambda2 * ZX' * ZX, analogously for ZY
+	std::pmr::vector <T> ax(m, memory), ay(m, memory);
 	for (int i = 0; i < m; i++)
 	{
-		const double dx = std::max(fabs(X1.coeff(i, 0) - X2.coeff(i, 0)), min_element);
-		const double dy = std::max(fabs(Y1.coeff(i, 0) - Y2.coeff(i, 0)), min_element);
-		ZX.insert(i, i) = 1.0 / dx;
-		ZY.insert(i, i) = 1.0 / dy;
+		ax[i] = ZX2(i) * (W(i) + 2.0 * lambda2);
+		ay[i] = ZY2(i) * (W(i) + 2.0 * lambda2);
 	}
 
-	//Inverse
-	const auto DT = D.transpose();
-	const auto ZXT = ZX.transpose();
-	const auto ZYT = ZY.transpose();
-	
-	solverx.compute(ZXT * W * ZX + lambda1 * DT * D + 2.0 * lambda2 * ZXT * ZX);
-	solvery.compute(ZYT * W * ZY + lambda1 * DT * D + 2.0 * lambda2 * ZYT * ZY);
+	//Right-hand sides stored in the output vectors
+	XS = ZX2.cwiseProduct(W.cwiseProduct(X) + lambda2 * (X1 + X2));
+	YS = ZY2.cwiseProduct(W.cwiseProduct(Y) + lambda2 * (Y1 + Y2));
 
-	const auto IX = solverx.solve(E);
-	const auto IY = solvery.solve(E);
+	//Banded LDLT factorizations sharing one pattern, half bandwidth k
+	if (!ldlt.isPatternAnalyzed(m, lambda1, k))
+		ldlt.analyzePattern(m, lambda1, k);
 
-	//Solution of AXS
-	const auto XS = IX * (ZXT * W * ZX * X + lambda2 * ZXT * ZX * (X1 + X2));
-	const auto YS = IY * (ZYT * W * ZY * Y + lambda2 * ZYT * ZY * (Y1 + Y2));
+	//Solution of AXS, right-hand sides are overwritten by the solution
+	ldlt.factorize(ax);
+	ldlt.solveInPlace(XS);
 
-	return { XS, YS };
+	ldlt.factorize(ay);
+	ldlt.solveInPlace(YS);
 }
 
 
 template <typename T>
-std::tuple<Eigen::SparseMatrix <T>, Eigen::SparseMatrix <T> > SplineSmoothing::smoothPolylineInCorridorAsLSS2(const Eigen::SparseMatrix <T>& X, const Eigen::SparseMatrix <T>& Y, const Eigen::SparseMatrix <T>& X1, const Eigen::SparseMatrix <T>& Y1, const Eigen::SparseMatrix <T>& X2, const Eigen::SparseMatrix <T>& Y2, const Eigen::SparseMatrix <T>& W, const T lambda1, const T lambda2, const int k)
+void SplineSmoothing::smoothPolylineInCorridorAsLSS2(const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X1, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y1, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X2, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y2, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& W, BandedLDLT <T>& ldlt, const T lambda1, const T lambda2, const int k, Eigen::Ref <Eigen::Matrix <T, Eigen::Dynamic, 1> > XS, Eigen::Ref <Eigen::Matrix <T, Eigen::Dynamic, 1> > YS, std::pmr::memory_resource* memory)
 {
 	//Spline smoothing with the constraints (Eigen version)
 	//Scaled version, asymetric least squares
-	const unsigned int m = X.rows();
-
-	//Create initial matrices
-	Eigen::SparseMatrix <T> E(m, m), ZX(m, m), ZY(m, m);
-	Eigen::SimplicialLDLT<Eigen::SparseMatrix<T> > solverx(E), solvery(E);
-	E.setIdentity();
-	const auto D = diff(E, k);
+	const int m = X.rows();
 
-	//Compute elements of ZX, ZY scaling matrices
+	//Compute squared elements of ZX, ZY diagonal scaling matrices
 	const double min_element = 0.01;
+	std::pmr::vector <T> zx2(m, memory), zy2(m, memory);
+	Eigen::Map <Eigen::Matrix <T, Eigen::Dynamic, 1> > ZX2(zx2.data(), m), ZY2(zy2.data(), m);
 	for (int i = 0; i < m; i++)
 	{
-		const double dx = std::max(fabs(X1.coeff(i, 0) - X2.coeff(i, 0)), min_element);
-		const double dy = std::max(fabs(Y1.coeff(i, 0) - Y2.coeff(i, 0)), min_element);
-		ZX.insert(i, i) = 1.0 / dx;
-		ZY.insert(i, i) = 1.0 / dy;
+		const double dx = std::max(fabs(X1(i) - X2(i)), min_element);
+		const double dy = std::max(fabs(Y1(i) - Y2(i)), min_element);
+		ZX2(i) = 1.0 / (dx * dx);
+		ZY2(i) = 1.0 / (dy * dy);
 	}
 
-	//Inverse
-	const auto DT = D.transpose();
-	const auto ZXT = ZX.transpose();
-	const auto ZYT = ZY.transpose();
-
-	solverx.compute(W + lambda1 * DT * D + 2.0 * lambda2 * ZXT * ZX);
-	solvery.compute(W + lambda1 * DT * D + 2.0 * lambda2 * ZYT * ZY);
-
-	const auto IX = solverx.solve(E);
-	const auto IY = solvery.solve(E);
+	//Diagonal parts of the matrices W + lambda1 * D' * D + 2 * lambda2 * ZX' * ZX, analogously for ZY
+	std::pmr::vector <T> ax(m, memory), ay(m, memory);
+	for (int i = 0; i < m; i++)
+	{
+		ax[i] = W(i) + 2.0 * lambda2 * ZX2(i);
+		ay[i] = W(i) + 2.0 * lambda2 * ZY2(i);
+	}
 
-	//Solution of AXS
-	const auto XS = IX * (W * X + lambda2 * ZXT * ZX * (X1 + X2));
-	const auto YS = IY * (W * Y + lambda2 * ZYT * ZY * (Y1 + Y2));
+	//Right-hand sides stored in the output vectors
+	XS = W.cwiseProduct(X) + lambda2 * ZX2.cwiseProduct(X1 + X2);
+	YS = W.cwiseProduct(Y) + lambda2 * ZY2.cwiseProduct(Y1 + Y2);
 
-	return { XS, YS };
-}
+	//Banded LDLT factorizations sharing one pattern, half bandwidth k
+	if (!ldlt.isPatternAnalyzed(m, lambda1, k))
+		ldlt.analyzePattern(m, lambda1, k);
 
+	//Solution of AXS, right-hand sides are overwritten by the solution
+	ldlt.factorize(ax);
+	ldlt.solveInPlace(XS);
 
-template <typename T>
-Eigen::SparseMatrix<T> SplineSmoothing::diff(Eigen::SparseMatrix<T> E, const int k)
-{
-	//Compute difference matrix
-	for (int i = 0; i < k; i++)
-	{
-		//Get submatrices
-		Eigen::SparseMatrix<T> E1 = E.block(0, 0, E.rows() - 1, E.cols());
-		Eigen::SparseMatrix<T> E2 = E.block(1, 0, E.rows() - 1, E.cols());
-
-		//Compute difference matrix
-		E = E2 - E1;
-	}
-
-	return E;
+	ldlt.factorize(ay);
+	ldlt.solveInPlace(YS);
 }
 
 
 template <typename T>
-std::tuple<Eigen::SparseMatrix <T>, Eigen::SparseMatrix <T> > SplineSmoothing::smoothPolylineInCorridorAsLS(const Eigen::SparseMatrix <T>& X, const Eigen::SparseMatrix <T>& Y, const Eigen::SparseMatrix <T>& X1, const Eigen::SparseMatrix <T>& Y1, const Eigen::SparseMatrix <T>& X2, const Eigen::SparseMatrix <T>& Y2, const Eigen::SparseMatrix <T>& W, const Eigen::SparseMatrix <T>& I0, const T lambda1, const T lambda2, const int k)
+void SplineSmoothing::smoothPolylineInCorridorAsLS(const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X1, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y1, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& X2, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& Y2, const Eigen::Ref <const Eigen::Matrix <T, Eigen::Dynamic, 1> >& W, BandedLDLTCache <T>& ldlt_cache, const T lambda1, const T lambda2, const int k, Eigen::Ref <Eigen::Matrix <T, Eigen::Dynamic, 1> > XS, Eigen::Ref <Eigen::Matrix <T, Eigen::Dynamic, 1> > YS, std::pmr::memory_resource* memory)
 {
 	//Spline smoothing with the constraints (Eigen version)
 	//Asymetric least squares
-	//Precomputed inverse matrix
-	const unsigned int m = X.rows();
-
-	//Create inerse matrix
-	Eigen::SparseMatrix <double> I(m, m);
-
-	//Assign precomputed invere matrix
-	if (I0.rows () == m)
-	{
-		I = I0;
-	}
-
-	//Different size, compute new inverse matrix
-	else
-	{
-		Eigen::SparseMatrix <double> E(m, m);
-		Eigen::SimplicialLDLT <Eigen::SparseMatrix<double> > solver(E);
-		E.setIdentity();
+	//Factorization shared by all parts of the same length
+	const int m = X.rows();
 
-		//Difference matrix
-		const auto D = SplineSmoothing::diff(E, k);
+	//Get factorization from the cache
+	const std::shared_ptr <const BandedLDLT <T> > ldlt = ldlt_cache.get(m, lambda1, lambda2, k);
 
-		//Inverse
-		const auto DT = D.transpose();
-		solver.compute(W + lambda1 * DT * D + 2.0 * lambda2 * E);
-		I = solver.solve(E);
-	}
+	//Solution of AXS, X and Y in one pass
+	std::pmr::vector <T> b(2 * m, memory);
+	Eigen::Map <Eigen::Matrix <T, Eigen::Dynamic, 2, Eigen::RowMajor> > B(b.data(), m, 2);
+	B.col(0) = W.cwiseProduct(X) + lambda2 * (X1 + X2);
+	B.col(1) = W.cwiseProduct(Y) + lambda2 * (Y1 + Y2);
 
-	//Solution of AXS
-	const auto XS = I * (W * X + lambda2 * (X1 + X2));
-	const auto YS = I * (W * Y + lambda2 * (Y1 + Y2));
+	ldlt->solveInPlace(B);
 
-	return { XS, YS };
+	XS = B.col(0);
+	YS = B.col(1);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,502 @@
+// Description: Batched reading of many small files using Linux io_uring
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "UringFileReader.h"
+
+#include <algorithm>
+
+#ifdef IO_URING_SUPPORTED
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#include "FileReadException.h"
+
+
+#ifdef IO_URING_SUPPORTED
+
+UringFileReader::UringFileReader() : ring_fd(-1), sq_ring(MAP_FAILED), cq_ring(MAP_FAILED), sqes(MAP_FAILED), sq_ring_size(0), cq_ring_size(0), sqes_size(0),
+	sq_entries(0), sq_head(nullptr), sq_tail(nullptr), sq_mask(nullptr), sq_array(nullptr), cq_head(nullptr), cq_tail(nullptr), cq_mask(nullptr), cqes(nullptr), sq_prepared(0), completed(0)
+{
+	//Create the ring and map its queues
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	ring_fd = syscall(__NR_io_uring_setup, QUEUE_ENTRIES, &params);
+
+	//Throw exception
+	if (ring_fd < 0)
+		throw FileReadException("FileReadException: can not initialize io_uring, ", strerror(errno));
+
+	sq_entries = params.sq_entries;
+	sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+	cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+	//Both rings share one mapping
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+		sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+
+	sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+
+	if (sq_ring != MAP_FAILED)
+		cq_ring = (params.features & IORING_FEAT_SINGLE_MMAP) ? sq_ring : mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+
+	if (cq_ring != MAP_FAILED)
+		sqes = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+
+	//Throw exception
+	if (sqes == MAP_FAILED)
+	{
+		release();
+		throw FileReadException("FileReadException: can not map io_uring queues, ", strerror(errno));
+	}
+
+	char* sq = (char*)sq_ring, * cq = (char*)cq_ring;
+	sq_head = (unsigned int*)(sq + params.sq_off.head);
+	sq_tail = (unsigned int*)(sq + params.sq_off.tail);
+	sq_mask = (unsigned int*)(sq + params.sq_off.ring_mask);
+	sq_array = (unsigned int*)(sq + params.sq_off.array);
+	cq_head = (unsigned int*)(cq + params.cq_off.head);
+	cq_tail = (unsigned int*)(cq + params.cq_off.tail);
+	cq_mask = (unsigned int*)(cq + params.cq_off.ring_mask);
+	cqes = cq + params.cq_off.cqes;
+	sq_prepared = completed = *sq_tail;
+
+	//Check the operations used by the reader, available since Linux 5.6
+	TVector <char> probe_data(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+	io_uring_probe* probe = (io_uring_probe*)probe_data.data();
+
+	bool supported = syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, 256) >= 0;
+
+	for (const int op : { IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_CLOSE })
+		supported = supported && (op <= probe->last_op) && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+
+	//Throw exception
+	if (!supported)
+	{
+		release();
+		throw FileReadException("FileReadException: io_uring does not support ", "openat, statx, read or close");
+	}
+}
+
+
+UringFileReader::~UringFileReader()
+{
+	release();
+}
+
+
+bool UringFileReader::isAvailable()
+{
+	//Try to create the ring
+	try
+	{
+		UringFileReader reader;
+		return true;
+	}
+
+	catch (Exception&)
+	{
+		return false;
+	}
+}
+
+
+void UringFileReader::readFiles(const TVector <std::string>& files, const std::function <void(const int, std::string_view)>& process, TVector <std::exception_ptr>& errors)
+{
+	//Read files in batches, the content of the i-th file is passed to process(i, content)
+	//Exception thrown while reading or processing the i-th file is stored in errors[i], reading stops after the batch
+	struct TSlot
+	{
+		int fd = -1;                    //Descriptor of the opened file, -1 when it is closed or its close is queued
+		struct statx stat;              //Size of the file
+		TVector <char> buffer;          //Content of the file
+		std::size_t read;               //Amount of read bytes
+		const char* error;              //Failed operation
+	};
+
+	const int n = files.size();
+	TVector <TSlot> slots(BATCH_SIZE);
+	int opened = 0;
+
+	//When the exception is thrown (e.g. by io_uring_enter), operations in flight are finished and files still opened are closed directly
+	struct TOpenedFiles
+	{
+		UringFileReader& reader;
+		TVector <TSlot>& slots;
+
+		~TOpenedFiles()
+		{
+			reader.drain();
+
+			for (TSlot& s : slots)
+				if (s.fd >= 0)
+					close(s.fd);
+		}
+	} opened_files{ *this, slots };
+
+	for (int first = 0; first < n; first += BATCH_SIZE)
+	{
+		const int count = std::min(BATCH_SIZE, n - first);
+		unsigned int expected = 0;
+
+		//Pass the content of the file to the parser, its exception is stored
+		auto parse = [&](const int j, std::string_view content)
+		{
+			try
+			{
+				process(first + j, content);
+			}
+
+			catch (...)
+			{
+				errors[first + j] = std::current_exception();
+			}
+		};
+
+		//Close files of the previous batch
+		for (int j = 0; j < opened; j++, expected++)
+		{
+			getEntry(IORING_OP_CLOSE, slots[j].fd, nullptr, 0, 0, CloseOperation, j);
+			slots[j].fd = -1;
+		}
+
+		//Open files of the batch and get their sizes
+		for (int j = 0; j < count; j++, expected += 2)
+		{
+			slots[j].fd = -1;
+			slots[j].read = 0;
+			slots[j].error = nullptr;
+
+			io_uring_sqe* sqe = (io_uring_sqe*)getEntry(IORING_OP_OPENAT, AT_FDCWD, files[first + j].c_str(), 0, 0, OpenOperation, j);
+			sqe->open_flags = O_RDONLY | O_CLOEXEC;
+
+			getEntry(IORING_OP_STATX, AT_FDCWD, files[first + j].c_str(), STATX_SIZE, (unsigned long long)&slots[j].stat, StatOperation, j);
+		}
+
+		for (; expected > 0; expected--)
+		{
+			TOperation operation;
+			int j, result;
+			waitCompletion(operation, j, result);
+
+			if (operation == OpenOperation)
+			{
+				if (result >= 0)
+					slots[j].fd = result;
+				else
+					slots[j].error = "FileReadException: can not open file. ";
+			}
+
+			else if ((operation == StatOperation) && (result < 0) && !slots[j].error)
+				slots[j].error = "FileReadException: can not get size of file. ";
+		}
+
+		//Read whole files of the batch, empty files are parsed immediately
+		for (int j = 0; j < count; j++)
+		{
+			if (slots[j].error)
+				continue;
+
+			slots[j].buffer.resize(slots[j].stat.stx_size);
+
+			if (slots[j].buffer.empty())
+				parse(j, std::string_view());
+
+			else
+			{
+				getEntry(IORING_OP_READ, slots[j].fd, slots[j].buffer.data(), (unsigned int)std::min <std::size_t>(slots[j].buffer.size(), MAX_READ_SIZE), 0, ReadOperation, j);
+				expected++;
+			}
+		}
+
+		//Process files in the order of completed reads
+		for (; expected > 0; expected--)
+		{
+			TOperation operation;
+			int j, result;
+			waitCompletion(operation, j, result);
+
+			TSlot& s = slots[j];
+
+			//Read failed
+			if (result < 0)
+			{
+				s.error = "FileReadException: can not read file. ";
+				continue;
+			}
+
+			s.read += result;
+
+			//Short or clamped read, read the rest of the file
+			if ((result > 0) && (s.read < s.buffer.size()))
+			{
+				getEntry(IORING_OP_READ, s.fd, s.buffer.data() + s.read, (unsigned int)std::min <std::size_t>(s.buffer.size() - s.read, MAX_READ_SIZE), s.read, ReadOperation, j);
+				expected++;
+				continue;
+			}
+
+			//Parse the content
+			parse(j, std::string_view(s.buffer.data(), s.read));
+		}
+
+		//Failed operations of the batch
+		bool failed = false;
+		for (int j = 0; j < count; j++)
+		{
+			if (slots[j].error)
+				errors[first + j] = std::make_exception_ptr(FileReadException(slots[j].error, files[first + j]));
+
+			failed = failed || errors[first + j];
+		}
+
+		//Opened files will be closed with the next batch, move them to the beginning
+		opened = 0;
+		for (int j = 0; j < count; j++)
+		{
+			if (slots[j].fd >= 0)
+				std::swap(slots[opened++].fd, slots[j].fd);
+		}
+
+		if (failed)
+			break;
+	}
+
+	//Close files of the last batch
+	for (int j = 0; j < opened; j++)
+	{
+		getEntry(IORING_OP_CLOSE, slots[j].fd, nullptr, 0, 0, CloseOperation, j);
+		slots[j].fd = -1;
+	}
+
+	for (unsigned int expected = opened; expected > 0; expected--)
+	{
+		TOperation operation;
+		int j, result;
+		waitCompletion(operation, j, result);
+	}
+}
+
+
+unsigned int UringFileReader::getUnsubmitted() const
+{
+	//Amount of prepared entries not consumed by the kernel
+	return sq_prepared - std::atomic_ref <unsigned int>(*sq_head).load(std::memory_order_acquire);
+}
+
+
+void* UringFileReader::getEntry(const unsigned char opcode, const int fd, const void* addr, const unsigned int len, const unsigned long long off, const TOperation operation, const int slot)
+{
+	//Prepare the next entry of the submission queue, it is submitted by waitCompletion
+	//Full queue is submitted first, submit() returns when the kernel has consumed all entries
+	if (getUnsubmitted() == sq_entries)
+		submit(0);
+
+	const unsigned int index = sq_prepared++ & *sq_mask;
+
+	io_uring_sqe* sqe = (io_uring_sqe*)sqes + index;
+	memset(sqe, 0, sizeof(io_uring_sqe));
+
+	sqe->opcode = opcode;
+	sqe->fd = fd;
+	sqe->addr = (unsigned long long)addr;
+	sqe->len = len;
+	sqe->off = off;
+	sqe->user_data = ((unsigned long long)operation << 32) | (unsigned int)slot;
+
+	sq_array[index] = index;
+
+	return sqe;
+}
+
+
+void UringFileReader::waitCompletion(TOperation& operation, int& slot, int& result)
+{
+	//Submit prepared entries and get the next completed operation, wait when no operation has completed yet
+	std::atomic_ref <unsigned int> tail(*cq_tail), head(*cq_head);
+
+	while (getUnsubmitted() > 0 || head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire))
+		submit((head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire)) ? 1 : 0);
+
+	//Consume the completion
+	const unsigned int h = head.load(std::memory_order_relaxed);
+	const io_uring_cqe* cqe = (const io_uring_cqe*)cqes + (h & *cq_mask);
+
+	operation = (TOperation)(cqe->user_data >> 32);
+	slot = (int)(cqe->user_data & 0xffffffff);
+	result = cqe->res;
+
+	head.store(h + 1, std::memory_order_release);
+	completed++;
+}
+
+
+void UringFileReader::drain()
+{
+	//Finish the reading stopped by the exception: nothing is submitted any more, files of the closes not consumed by the kernel are closed directly
+	//Operations consumed by the kernel are waited for (they still write to the buffers), files opened by them are closed
+	std::atomic_ref <unsigned int> sq_h(*sq_head), tail(*cq_tail), head(*cq_head);
+
+	for (unsigned int i = sq_h.load(std::memory_order_acquire); i != sq_prepared; i++)
+	{
+		const io_uring_sqe* sqe = (const io_uring_sqe*)sqes + (i & *sq_mask);
+
+		if (sqe->opcode == IORING_OP_CLOSE)
+			close(sqe->fd);
+	}
+
+	sq_prepared = sq_h.load(std::memory_order_acquire);
+	std::atomic_ref <unsigned int>(*sq_tail).store(sq_prepared, std::memory_order_release);
+
+	while (completed != sq_prepared)
+	{
+		//Wait for the next completion, stop when the ring does not work
+		if (head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire))
+		{
+			if ((syscall(__NR_io_uring_enter, ring_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0) && (errno != EINTR) && (errno != EAGAIN))
+				break;
+
+			continue;
+		}
+
+		const unsigned int h = head.load(std::memory_order_relaxed);
+		const io_uring_cqe* cqe = (const io_uring_cqe*)cqes + (h & *cq_mask);
+
+		if (((TOperation)(cqe->user_data >> 32) == OpenOperation) && (cqe->res >= 0))
+			close(cqe->res);
+
+		head.store(h + 1, std::memory_order_release);
+		completed++;
+	}
+}
+
+
+void UringFileReader::submit(const unsigned int min_complete)
+{
+	//Submit prepared entries, wait for min_complete completions
+	//The kernel may consume only a part of the entries or be interrupted, the rest is submitted again
+	std::atomic_ref <unsigned int>(*sq_tail).store(sq_prepared, std::memory_order_release);
+
+	for (;;)
+	{
+		const unsigned int to_submit = getUnsubmitted();
+		const int submitted = syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, min_complete > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+
+		//Interrupted or out of resources, try again
+		if ((submitted < 0) && ((errno == EINTR) || (errno == EAGAIN)))
+			continue;
+
+		//Throw exception
+		if ((submitted < 0) || ((submitted == 0) && (to_submit > 0)))
+			throw FileReadException("FileReadException: can not submit io_uring operations, ", submitted < 0 ? strerror(errno) : "no entry consumed");
+
+		//All entries have been consumed
+		if (getUnsubmitted() == 0)
+			break;
+	}
+}
+
+
+void UringFileReader::release()
+{
+	//Unmap queues and close the ring
+	if (sqes != MAP_FAILED)
+		munmap(sqes, sqes_size);
+
+	if ((cq_ring != MAP_FAILED) && (cq_ring != sq_ring))
+		munmap(cq_ring, cq_ring_size);
+
+	if (sq_ring != MAP_FAILED)
+		munmap(sq_ring, sq_ring_size);
+
+	if (ring_fd >= 0)
+		close(ring_fd);
+
+	sqes = cq_ring = sq_ring = MAP_FAILED;
+	ring_fd = -1;
+}
+
+#else
+
+UringFileReader::UringFileReader() : ring_fd(-1), sq_ring(nullptr), cq_ring(nullptr), sqes(nullptr), sq_ring_size(0), cq_ring_size(0), sqes_size(0),
+	sq_entries(0), sq_head(nullptr), sq_tail(nullptr), sq_mask(nullptr), sq_array(nullptr), cq_head(nullptr), cq_tail(nullptr), cq_mask(nullptr), cqes(nullptr), sq_prepared(0), completed(0)
+{
+	//Throw exception
+	throw FileReadException("FileReadException: io_uring is not supported ", "on this platform");
+}
+
+
+UringFileReader::~UringFileReader()
+{
+}
+
+
+bool UringFileReader::isAvailable()
+{
+	return false;
+}
+
+
+void UringFileReader::readFiles(const TVector <std::string>& /*files*/, const std::function <void(const int, std::string_view)>& /*process*/, TVector <std::exception_ptr>& /*errors*/)
+{
+}
+
+
+unsigned int UringFileReader::getUnsubmitted() const
+{
+	return 0;
+}
+
+
+void* UringFileReader::getEntry(const unsigned char /*opcode*/, const int /*fd*/, const void* /*addr*/, const unsigned int /*len*/, const unsigned long long /*off*/, const TOperation /*operation*/, const int /*slot*/)
+{
+	return nullptr;
+}
+
+
+void UringFileReader::submit(const unsigned int /*min_complete*/)
+{
+}
+
+
+void UringFileReader::waitCompletion(TOperation& /*operation*/, int& /*slot*/, int& /*result*/)
+{
+}
+
+
+void UringFileReader::drain()
+{
+}
+
+
+void UringFileReader::release()
+{
+}
+
+#endif
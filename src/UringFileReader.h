@@ -0,0 +1,93 @@
+// Description: Batched reading of many small files using Linux io_uring
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef UringFileReader_H
+#define UringFileReader_H
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <exception>
+
+#include "TVector.h"
+
+//io_uring is available only on Linux with the kernel headers, other platforms use the fallback reader
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define IO_URING_SUPPORTED
+#endif
+
+//Batched reader of many small files using the Linux io_uring submission and completion queues
+//Opens and sizes of the batch of files are submitted at once, then the reads of the whole files;
+//each completed buffer is passed to the parser while the other reads are still running.
+//Files of the batch are closed together with the opens of the next batch.
+//The constructor throws when io_uring is not available (old kernel, disabled by the system):
+//the caller falls back to the parallel reader, see isAvailable().
+class UringFileReader
+{
+        private:
+                static const unsigned int QUEUE_ENTRIES = 256;  //Entries of the submission queue
+                static const int BATCH_SIZE = 64;               //Files opened and read in one batch
+                static const unsigned int MAX_READ_SIZE = 0x7ffff000;   //Maximum length of one read, the result is a 32-bit signed integer
+
+                //Closes of the previous batch, opens and sizes of the batch are in flight together, the completion queue is twice as large
+                static_assert(3 * BATCH_SIZE <= QUEUE_ENTRIES, "UringFileReader: the batch does not fit in the submission queue");
+
+                //Operation of the queue entry, stored in the upper half of its user data
+                typedef enum
+                {
+                        OpenOperation = 1,
+                        StatOperation,
+                        ReadOperation,
+                        CloseOperation
+                } TOperation;
+
+                int ring_fd;                            //Descriptor of the ring
+                void* sq_ring;                          //Mapped submission queue ring
+                void* cq_ring;                          //Mapped completion queue ring
+                void* sqes;                             //Mapped submission queue entries
+                std::size_t sq_ring_size, cq_ring_size, sqes_size;
+                unsigned int sq_entries;                //Amount of entries of the submission queue
+                unsigned int* sq_head, * sq_tail, * sq_mask, * sq_array;
+                unsigned int* cq_head, * cq_tail, * cq_mask;
+                void* cqes;                             //Completion queue entries inside the mapped ring
+                unsigned int sq_prepared;               //Tail of the prepared entries, entries between the head and this tail are not consumed by the kernel yet
+                unsigned int completed;                 //Amount of consumed completions, each entry consumed by the kernel has one completion
+
+        public:
+                UringFileReader();
+                UringFileReader(const UringFileReader&) = delete;
+                UringFileReader& operator = (const UringFileReader&) = delete;
+                ~UringFileReader();
+
+        public:
+                static bool isAvailable();
+                void readFiles(const TVector <std::string>& files, const std::function <void(const int, std::string_view)>& process, TVector <std::exception_ptr>& errors);
+
+        private:
+                unsigned int getUnsubmitted() const;
+                void* getEntry(const unsigned char opcode, const int fd, const void* addr, const unsigned int len, const unsigned long long off, const TOperation operation, const int slot);
+                void submit(const unsigned int min_complete);
+                void waitCompletion(TOperation& operation, int& slot, int& result);
+                void drain();
+                void release();
+};
+
+#endif
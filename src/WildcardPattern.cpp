@@ -0,0 +1,97 @@
+// Description: Wildcard pattern compiled into literal segments, matching without allocations
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "WildcardPattern.h"
+
+
+WildcardPattern::WildcardPattern(const std::string& pattern) : star(false), min_length(0)
+{
+	//Split the pattern by *, consecutive * are merged
+	segments.emplace_back();
+
+	for (const char c : pattern)
+	{
+		if (c == '*')
+		{
+			star = true;
+
+			if (!segments.back().empty() || segments.size() == 1)
+				segments.emplace_back();
+		}
+
+		else
+		{
+			segments.back().push_back(c);
+			min_length++;
+		}
+	}
+}
+
+
+bool WildcardPattern::match(std::string_view s) const
+{
+	//Match the string to the pattern
+	if (s.size() < min_length)
+		return false;
+
+	//No *, the whole string must match the only segment
+	if (!star)
+		return (s.size() == segments[0].size()) && matchSegment(s, segments[0]);
+
+	//First segment at the beginning, last segment at the end
+	const std::string& prefix = segments.front(), & suffix = segments.back();
+
+	if (!matchSegment(s.substr(0, prefix.size()), prefix) || !matchSegment(s.substr(s.size() - suffix.size()), suffix))
+		return false;
+
+	//Find middle segments from left to right between the first and the last one
+	std::size_t pos = prefix.size();
+	const std::size_t end = s.size() - suffix.size();
+
+	for (std::size_t i = 1; i + 1 < segments.size(); i++)
+	{
+		const std::string& segment = segments[i];
+
+		while ((pos + segment.size() <= end) && !matchSegment(s.substr(pos, segment.size()), segment))
+			pos++;
+
+		//Segment not found
+		if (pos + segment.size() > end)
+			return false;
+
+		pos += segment.size();
+	}
+
+	return true;
+}
+
+
+bool WildcardPattern::matchSegment(std::string_view s, const std::string& segment)
+{
+	//Compare the string and the segment of the same length, ? matches any character
+	for (std::size_t i = 0; i < segment.size(); i++)
+	{
+		if ((segment[i] != s[i]) && (segment[i] != '?'))
+			return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,51 @@
+// Description: Wildcard pattern compiled into literal segments, matching without allocations
+
+// Copyright (c) 2021 - 2023
+// Tomas Bayer
+// Charles University in Prague, Faculty of Science
+// bayertom@natur.cuni.cz
+
+// This library is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef WildcardPattern_H
+#define WildcardPattern_H
+
+#include <string>
+#include <string_view>
+
+#include "TVector.h"
+
+//Wildcard pattern with * (any sequence) and ? (any character), compiled once and matched many times
+//The pattern is split by * into literal segments: the first one is anchored at the beginning of the string,
+//the last one at its end, the middle ones are found greedily from left to right.
+//Matching is linear for the typical masks (*name*.csv) and allocates no memory.
+class WildcardPattern
+{
+        private:
+                TVector <std::string> segments;         //Literal segments between *, ? matches any character
+                bool star;                              //Pattern contains *
+                std::size_t min_length;                 //Total length of the segments
+
+        public:
+                WildcardPattern(const std::string& pattern);
+
+        public:
+                bool match(std::string_view s) const;
+
+        private:
+                static bool matchSegment(std::string_view s, const std::string& segment);
+};
+
+#endif